@@ -0,0 +1,512 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "components.hpp"
+#include "harness.hpp"
+#include "images.hpp"
+#include "lib.hpp"
+#include "lib/png.hpp"
+#include "lib/third_party/stb_image.h"
+#include "resources.hpp"
+#include "world.hpp"
+
+namespace {
+
+// Software renderer drawing into a small surface, so no window or GPU is needed
+class OffscreenRenderer {
+  public:
+    OffscreenRenderer(int width = 64, int height = 64) {
+        m_surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32);
+        m_renderer = SDL_CreateSoftwareRenderer(m_surface);
+    }
+
+    ~OffscreenRenderer() {
+        SDL_DestroyRenderer(m_renderer);
+        SDL_DestroySurface(m_surface);
+    }
+
+    SDL_Renderer* renderer() const {
+        return m_renderer;
+    }
+
+  private:
+    SDL_Surface* m_surface = nullptr;
+    SDL_Renderer* m_renderer = nullptr;
+};
+
+void transformGetMatrix(bench::State& state) {
+    Transform transform;
+    transform.setPosition({12.0f, 4.0f});
+    transform.setRotation(0.3f);
+    transform.setScale({2.0f, 0.5f});
+    for (auto _ : state) {
+        bench::doNotOptimize(transform.getMatrix());
+        transform.setRotation(transform.getRotation() + 0.001f);
+    }
+}
+
+void mathRandom(bench::State& state) {
+    math::seed(1);
+    for (auto _ : state) {
+        bench::doNotOptimize(math::random());
+    }
+}
+
+void randomFill(bench::State& state) {
+    math::Random random(1);
+    std::vector<float> values(4096);
+    for (auto _ : state) {
+        random.fill(values, -1.0f, 1.0f);
+        bench::doNotOptimize(values.data());
+    }
+    state.counter("values", static_cast<double>(values.size()));
+}
+
+void addRenderCounters(bench::State& state, const RenderStats& stats) {
+    state.counter("drawCalls", stats.drawCalls);
+    state.counter("vertices", stats.vertices);
+    state.counter("indices", stats.indices);
+    state.counter("textureBinds", stats.textureBinds);
+    state.counter("colorModChanges", stats.colorModChanges);
+}
+
+// Box2D's own stage timings, averaged over the measured steps, and the world's counts
+struct PhysicsCounters {
+    double step = 0.0;
+    double pairs = 0.0;
+    double collide = 0.0;
+    double solve = 0.0;
+    double continuous = 0.0;
+    int steps = 0;
+
+    void add(const PhysicsSystem& physics) {
+        auto profile = physics.getProfile();
+        step += profile.step;
+        pairs += profile.pairs;
+        collide += profile.collide;
+        solve += profile.solve;
+        continuous += profile.continuous;
+        steps++;
+    }
+
+    void report(bench::State& state, const PhysicsSystem& physics) const {
+        const double n = steps > 0 ? steps : 1;
+        state.counter("physicsStepMs", step / n);
+        state.counter("physicsPairsMs", pairs / n);
+        state.counter("physicsCollideMs", collide / n);
+        state.counter("physicsSolveMs", solve / n);
+        state.counter("physicsContinuousMs", continuous / n);
+
+        auto counters = physics.getCounters();
+        state.counter("physicsBodies", counters.bodyCount);
+        state.counter("physicsContacts", counters.contactCount);
+        state.counter("physicsIslands", counters.islandCount);
+        state.counter("physicsTreeHeight", counters.treeHeight);
+    }
+};
+
+// ComponentStats per component type: calls and milliseconds as means per frame, the longest
+// single call over all frames, e.g. "PlayerComponent.updateMs". Empty unless built with
+// Q14_COMPONENT_STATS.
+struct ComponentCounters {
+    struct Totals {
+        double calls[2] = {};
+        double ms[2] = {};
+        double maxUs[2] = {};
+    };
+    std::map<std::string, Totals> types;
+    int frames = 0;
+
+    void add() {
+        ComponentStats::endFrame();
+        for (const auto& stats : ComponentStats::lastFrame()) {
+            auto& totals = types[stats.name];
+            for (auto phase : {ComponentStats::Phase::Update, ComponentStats::Phase::Render}) {
+                const int i = static_cast<int>(phase);
+                totals.calls[i] += stats[phase].calls;
+                totals.ms[i] += Profiler::toMilliseconds(stats[phase].ticks);
+                const double maxUs = Profiler::toMilliseconds(stats[phase].maxTicks) * 1000.0;
+                totals.maxUs[i] = std::max(totals.maxUs[i], maxUs);
+            }
+        }
+        frames++;
+    }
+
+    void report(bench::State& state) const {
+        const double n = frames > 0 ? frames : 1;
+        for (const auto& [name, totals] : types) {
+            state.counter((name + ".updateCalls").c_str(), totals.calls[0] / n);
+            state.counter((name + ".updateMs").c_str(), totals.ms[0] / n);
+            state.counter((name + ".updateMaxUs").c_str(), totals.maxUs[0]);
+            state.counter((name + ".renderCalls").c_str(), totals.calls[1] / n);
+            state.counter((name + ".renderMs").c_str(), totals.ms[1] / n);
+            state.counter((name + ".renderMaxUs").c_str(), totals.maxUs[1]);
+        }
+    }
+};
+
+void renderContextDrawTexture(bench::State& state) {
+    const int count = 1000;
+    OffscreenRenderer offscreen;
+    RenderContext context(offscreen.renderer());
+    context.setTransform(Transform());
+
+    auto image = ResourceLoader::loadImage(Resources::Images::Tiles::Tile_0010);
+    auto texture = context.createTexture(image.info, image.pixels);
+    context.setTexture(texture);
+
+    Rect rect{{-0.5f, -0.5f}, {1.0f, 1.0f}};
+    Rect uv{{0.0f, 0.0f}, {1.0f, 1.0f}};
+    Transform transform;
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            transform.setPosition({static_cast<float>(i % 64), static_cast<float>(i / 64)});
+            context.drawTexture(rect, uv, transform.getMatrix());
+        }
+        SDL_FlushRenderer(offscreen.renderer());
+        context.endFrameStats();
+    }
+    state.counter("quads", count);
+    addRenderCounters(state, context.lastFrameStats());
+    context.deleteTexture(texture);
+}
+
+void resourceLoaderLoadImage(bench::State& state, std::span<const uint8_t> data) {
+    for (auto _ : state) {
+        auto image = ResourceLoader::loadImage(data);
+        bench::doNotOptimize(image.pixels.data.data());
+    }
+    state.counter("bytes", static_cast<double>(data.size()));
+}
+
+// Decodes every embedded image into one reused buffer, with the Png decoder or with stb_image as
+// the baseline it replaces
+void decodeEmbeddedImages(bench::State& state, bool stb) {
+    auto images = bench::embeddedImages();
+    double bytes = 0;
+    double pixels = 0;
+    for (auto data : images) {
+        ImageInfo info;
+        Png::readInfo(data, info);
+        bytes += static_cast<double>(data.size());
+        pixels += static_cast<double>(info.width) * info.height;
+    }
+    std::vector<uint8_t> buffer;
+    for (auto _ : state) {
+        for (auto data : images) {
+            if (stb) {
+                int width, height;
+                auto image = stbi_load_from_memory(data.data(), static_cast<int>(data.size()),
+                                                   &width, &height, nullptr, 4);
+                bench::doNotOptimize(image);
+                stbi_image_free(image);
+            } else {
+                ImageInfo info;
+                Png::readInfo(data, info);
+                buffer.resize(static_cast<size_t>(info.width) * info.height * 4);
+                Png::decode(data, {buffer, info.width * 4});
+                bench::doNotOptimize(buffer.data());
+            }
+        }
+    }
+    state.counter("images", static_cast<double>(images.size()));
+    state.counter("bytes", bytes);
+    state.counter("pixels", pixels);
+}
+
+enum class ImageCacheState { Off, Cold, Warm };
+
+// Startup texture loading of every embedded image: without the image cache, with an empty cache
+// that decodes everything and writes the file, and with the file the previous run wrote
+void loadEmbeddedTextures(bench::State& state, ImageCacheState cache) {
+    const std::string path = prefPath("bench_images.q14c");
+    auto images = bench::embeddedImages();
+    OffscreenRenderer offscreen;
+    RenderContext context(offscreen.renderer());
+    std::vector<Texture> textures;
+    auto load = [&] {
+        for (auto data : images) {
+            textures.push_back(ResourceLoader::loadTexture(context, data));
+        }
+    };
+    std::remove(path.c_str());
+    if (cache == ImageCacheState::Warm) {
+        ImageCache::open(path.c_str());
+        load();
+        ImageCache::close();
+    }
+    for (auto _ : state) {
+        if (cache == ImageCacheState::Cold) {
+            state.pause();
+            std::remove(path.c_str());
+            state.resume();
+        }
+        if (cache != ImageCacheState::Off) {
+            ImageCache::open(path.c_str());
+        }
+        load();
+        if (cache != ImageCacheState::Off) {
+            state.counter("hits", static_cast<double>(ImageCache::stats().hits));
+            ImageCache::close();
+        }
+        state.pause();
+        for (auto texture : textures) {
+            context.deleteTexture(texture);
+        }
+        textures.clear();
+        state.resume();
+    }
+    std::remove(path.c_str());
+    state.counter("images", static_cast<double>(images.size()));
+}
+
+// Decodes and uploads the world's textures, either one after the other on this thread or through
+// the ResourceLoader workers
+void resourceLoaderLoadTextures(bench::State& state, bool async) {
+    namespace Images = Resources::Images;
+    const std::span<const uint8_t> images[] = {
+        Images::Characters::Tile_0000, Images::Characters::Tile_0022, Images::Tiles::Tile_0006,
+        Images::Tiles::Tile_0001,      Images::Tiles::Tile_0002,      Images::Tiles::Tile_0003,
+        Images::Tiles::Tile_0020,      Images::Tiles::Tile_0120,      Images::Tiles::Tile_0140,
+        Images::Tiles::Tile_0010,
+    };
+    OffscreenRenderer offscreen;
+    RenderContext context(offscreen.renderer());
+    std::vector<Texture> textures;
+    for (auto _ : state) {
+        if (async) {
+            std::vector<ResourceLoader::Handle> handles;
+            for (auto data : images) {
+                handles.push_back(ResourceLoader::loadTextureAsync(data));
+            }
+            ResourceLoader::finish(context);
+            for (auto handle : handles) {
+                textures.push_back(ResourceLoader::texture(handle));
+            }
+        } else {
+            for (auto data : images) {
+                auto image = ResourceLoader::loadImage(data);
+                textures.push_back(context.createTexture(image.info, image.pixels));
+            }
+        }
+        for (auto texture : textures) {
+            context.deleteTexture(texture);
+        }
+        textures.clear();
+    }
+    state.counter("textures", static_cast<double>(std::size(images)));
+}
+
+void physicsSystemUpdate(bench::State& state, int bodyCount) {
+    PhysicsSystem physics;
+    physics.init();
+
+    std::vector<GameObject> objects;
+    objects.reserve(bodyCount + 1);
+    math::Random random;
+    GameContext context{&objects, &physics, &random};
+
+    const int columns = std::max(1, bodyCount / 10);
+    {
+        auto& ground = objects.emplace_back();
+        b2Polygon polygon = b2MakeBox(columns * 1.5f, 0.5f);
+        ground.addComponent(physics.createBody({columns * 0.75f, 11.0f}, b2_staticBody))
+            ->addShape(b2DefaultShapeDef(), polygon);
+    }
+    for (int i = 0; i < bodyCount; i++) {
+        auto& obj = objects.emplace_back();
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.enableSleep = false;
+        bodyDef.position = {(i % columns) * 1.5f, 10.0f - (i / columns) * 1.05f};
+
+        b2Polygon polygon = b2MakeBox(0.5f, 0.5f);
+        obj.addComponent(physics.createBody(bodyDef), Components::Tags::PHYSICS)
+            ->addShape(b2DefaultShapeDef(), polygon);
+    }
+    for (auto& obj : objects) {
+        obj.init(context);
+    }
+
+    UpdateContext updateContext;
+    uint64_t ticks = 0;
+    updateContext.setTicks(ticks);
+    PhysicsCounters physicsCounters;
+    for (auto _ : state) {
+        ticks += 16;
+        updateContext.setTicks(ticks);
+        physics.update(updateContext);
+        physicsCounters.add(physics);
+    }
+    state.counter("bodies", bodyCount);
+    physicsCounters.report(state, physics);
+
+    for (auto& obj : objects) {
+        obj.deinit(context);
+    }
+}
+
+std::vector<GameObject> createComponentObjects(int count, int componentsPerObject) {
+    std::vector<GameObject> objects;
+    objects.reserve(count);
+    for (int i = 0; i < count; i++) {
+        auto& obj = objects.emplace_back();
+        for (int j = 0; j < componentsPerObject; j++) {
+            obj.addComponent(std::make_unique<Component>(), j);
+        }
+    }
+    return objects;
+}
+
+void gameObjectUpdate(bench::State& state) {
+    const int count = 1000;
+    const int componentsPerObject = 8;
+    auto objects = createComponentObjects(count, componentsPerObject);
+    GameContext context{&objects, nullptr, nullptr};
+    UpdateContext updateContext;
+    updateContext.setTicks(0);
+    for (auto _ : state) {
+        for (auto& obj : objects) {
+            obj.update(context, updateContext);
+        }
+    }
+    state.counter("components", count * componentsPerObject);
+}
+
+void gameObjectGetComponentByTag(bench::State& state) {
+    const int count = 1000;
+    const int componentsPerObject = 8;
+    auto objects = createComponentObjects(count, componentsPerObject);
+    int tag = 0;
+    for (auto _ : state) {
+        for (auto& obj : objects) {
+            bench::doNotOptimize(obj.getComponentByTag(tag));
+        }
+        tag = (tag + 1) % componentsPerObject;
+    }
+    state.counter("objects", count);
+}
+
+void nodeGlobalTransform(bench::State& state, int depth) {
+    auto root = std::make_unique<Node>();
+    Node* leaf = root.get();
+    for (int i = 0; i < depth; i++) {
+        auto child = std::make_unique<Node>();
+        child->setPosition({1.0f, 0.5f});
+        child->setAngle(5.0f);
+        child->setScale(1.01f);
+        auto next = child.get();
+        leaf->addChild(std::move(child));
+        leaf = next;
+    }
+    Vec2 point{0.5f, 0.5f};
+    for (auto _ : state) {
+        bench::doNotOptimize(leaf->convertToWorldSpace(point));
+    }
+    state.counter("depth", depth);
+}
+
+void gameWorldFrame(bench::State& state, SceneConfig config) {
+    OffscreenRenderer offscreen(256, 256);
+    RenderContext renderContext(offscreen.renderer());
+    UpdateContext updateContext;
+    uint64_t ticks = 0;
+    updateContext.setTicks(ticks);
+
+    GameWorld world(config);
+    world.init(updateContext, renderContext);
+    world.resize({256, 256});
+    PhysicsCounters physicsCounters;
+    ComponentCounters componentCounters;
+    // Drops the calls made by init
+    ComponentStats::endFrame();
+    for (auto _ : state) {
+        ticks += 16;
+        updateContext.setTicks(ticks);
+        world.update(updateContext);
+        physicsCounters.add(*world.getContext().physics);
+        world.render(renderContext);
+        renderContext.flush();
+        SDL_FlushRenderer(offscreen.renderer());
+        renderContext.endFrameStats();
+        componentCounters.add();
+    }
+    addRenderCounters(state, renderContext.lastFrameStats());
+    physicsCounters.report(state, *world.getContext().physics);
+    componentCounters.report(state);
+    state.counter("platforms", config.platforms);
+    state.counter("crates", config.crates);
+    state.counter("enemies", config.enemies);
+}
+
+SceneConfig stressScene(int scale) {
+    SceneConfig config;
+    config.platforms = scale;
+    config.crates = scale * 4;
+    config.enemies = scale / 2;
+    config.enemySpawnInterval = 0.0f;
+    config.projectileRate = static_cast<float>(scale) / 10.0f;
+    return config;
+}
+
+}  // namespace
+
+BENCHMARK("Transform::getMatrix", transformGetMatrix);
+BENCHMARK("math::random", mathRandom);
+BENCHMARK("math::Random::fill/4096", randomFill);
+BENCHMARK("RenderContext::drawTexture/1000", renderContextDrawTexture);
+BENCHMARK("ResourceLoader::loadImage/Characters::Tile_0000", [](bench::State& state) {
+    resourceLoaderLoadImage(state, Resources::Images::Characters::Tile_0000);
+});
+BENCHMARK("ResourceLoader::loadImage/Tiles::Tile_0001", [](bench::State& state) {
+    resourceLoaderLoadImage(state, Resources::Images::Tiles::Tile_0001);
+});
+BENCHMARK("Png::decode/Resources::Images", [](bench::State& state) {
+    decodeEmbeddedImages(state, false);
+});
+BENCHMARK("stbi_load_from_memory/Resources::Images", [](bench::State& state) {
+    decodeEmbeddedImages(state, true);
+});
+BENCHMARK("ImageCache::startup/off", [](bench::State& state) {
+    loadEmbeddedTextures(state, ImageCacheState::Off);
+});
+BENCHMARK("ImageCache::startup/cold", [](bench::State& state) {
+    loadEmbeddedTextures(state, ImageCacheState::Cold);
+});
+BENCHMARK("ImageCache::startup/warm", [](bench::State& state) {
+    loadEmbeddedTextures(state, ImageCacheState::Warm);
+});
+BENCHMARK("ResourceLoader::loadTextures/serial", [](bench::State& state) {
+    resourceLoaderLoadTextures(state, false);
+});
+BENCHMARK("ResourceLoader::loadTextures/async", [](bench::State& state) {
+    resourceLoaderLoadTextures(state, true);
+});
+BENCHMARK("PhysicsSystem::update/100", [](bench::State& state) { physicsSystemUpdate(state, 100); });
+BENCHMARK("PhysicsSystem::update/1000",
+          [](bench::State& state) { physicsSystemUpdate(state, 1000); });
+BENCHMARK("PhysicsSystem::update/10000",
+          [](bench::State& state) { physicsSystemUpdate(state, 10000); });
+BENCHMARK("GameObject::update/1000x8", gameObjectUpdate);
+BENCHMARK("GameObject::getComponentByTag/1000x8", gameObjectGetComponentByTag);
+BENCHMARK("Node::convertToWorldSpace/depth4", [](bench::State& state) {
+    nodeGlobalTransform(state, 4);
+});
+BENCHMARK("Node::convertToWorldSpace/depth32", [](bench::State& state) {
+    nodeGlobalTransform(state, 32);
+});
+BENCHMARK("GameWorld::frame/default", [](bench::State& state) {
+    gameWorldFrame(state, SceneConfig());
+});
+BENCHMARK("GameWorld::frame/stress100", [](bench::State& state) {
+    gameWorldFrame(state, stressScene(100));
+});
+BENCHMARK("GameWorld::frame/stress1000", [](bench::State& state) {
+    gameWorldFrame(state, stressScene(1000));
+});
@@ -0,0 +1,213 @@
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace bench {
+
+namespace {
+
+struct Entry {
+    std::string name;
+    Function function;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    std::vector<double> samples;
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+std::vector<Entry>& registry() {
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+double runOnce(const Entry& entry, uint64_t iterations, Result* result) {
+    State state(iterations);
+    entry.function(state);
+    if (result) {
+        result->counters = state.counters();
+    }
+    return static_cast<double>(state.elapsed().count());
+}
+
+// Doubles the iteration count until a single repetition takes at least minTimeMs
+uint64_t calibrate(const Entry& entry, double minTimeMs) {
+    const double minTimeNs = minTimeMs * 1e6;
+    uint64_t iterations = 1;
+    while (iterations < (1ull << 30)) {
+        double elapsed = runOnce(entry, iterations, nullptr);
+        if (elapsed >= minTimeNs) {
+            break;
+        }
+        double factor = elapsed > 0 ? std::clamp(minTimeNs / elapsed * 1.2, 2.0, 10.0) : 10.0;
+        iterations = static_cast<uint64_t>(std::ceil(iterations * factor));
+    }
+    return iterations;
+}
+
+bool pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    auto index = static_cast<size_t>(std::round(p * (values.size() - 1)));
+    return values[index];
+}
+
+void writeEscaped(FILE* file, const std::string& str) {
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(c, file);
+    }
+}
+
+void writeJson(FILE* file, const Options& options, const std::vector<Result>& results) {
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"version\": \"%s\",\n", FULL_VERSION_STRING);
+    std::fprintf(file, "  \"cpu\": %d,\n", options.cpu);
+    std::fprintf(file, "  \"warmup\": %d,\n", options.warmup);
+    std::fprintf(file, "  \"repetitions\": %d,\n", options.repetitions);
+    std::fprintf(file, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        std::vector<double> perIteration;
+        for (double sample : result.samples) {
+            perIteration.push_back(sample / result.iterations);
+        }
+        double mean = std::accumulate(perIteration.begin(), perIteration.end(), 0.0) /
+                      std::max<size_t>(perIteration.size(), 1);
+        double variance = 0;
+        for (double v : perIteration) {
+            variance += (v - mean) * (v - mean);
+        }
+        variance /= std::max<size_t>(perIteration.size(), 1);
+
+        std::fprintf(file, "    {\n      \"name\": \"");
+        writeEscaped(file, result.name);
+        std::fprintf(file, "\",\n");
+        std::fprintf(file, "      \"iterations\": %llu,\n",
+                     static_cast<unsigned long long>(result.iterations));
+        std::fprintf(file,
+                     "      \"ns_per_iteration\": {\"min\": %.3f, \"median\": %.3f, \"mean\": "
+                     "%.3f, \"max\": %.3f, \"stddev\": %.3f},\n",
+                     percentile(perIteration, 0.0), percentile(perIteration, 0.5), mean,
+                     percentile(perIteration, 1.0), std::sqrt(variance));
+        std::fprintf(file, "      \"counters\": {");
+        for (size_t j = 0; j < result.counters.size(); j++) {
+            std::fprintf(file, "%s\"", j > 0 ? ", " : "");
+            writeEscaped(file, result.counters[j].first);
+            std::fprintf(file, "\": %.6g", result.counters[j].second);
+        }
+        std::fprintf(file, "}\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+}  // namespace
+
+void State::counter(const char* name, double value) {
+    for (auto& entry : m_counters) {
+        if (entry.first == name) {
+            entry.second = value;
+            return;
+        }
+    }
+    m_counters.emplace_back(name, value);
+}
+
+void add(std::string name, Function function) {
+    registry().push_back({std::move(name), std::move(function)});
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--warmup") == 0 && value) {
+            options.warmup = std::atoi(value);
+        } else if (std::strcmp(arg, "--repetitions") == 0 && value) {
+            options.repetitions = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--min-time") == 0 && value) {
+            options.minTimeMs = std::atof(value);
+        } else if (std::strcmp(arg, "--cpu") == 0 && value) {
+            options.cpu = std::atoi(value);
+        } else if (std::strcmp(arg, "--filter") == 0 && value) {
+            options.filter = value;
+        } else if (std::strcmp(arg, "--output") == 0 && value) {
+            options.output = value;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--warmup N] [--repetitions N] [--min-time MS] [--cpu N] "
+                         "[--filter SUBSTRING] [--output FILE]\n",
+                         argv[0]);
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+int run(const Options& options) {
+    if (options.cpu >= 0 && !pinToCpu(options.cpu)) {
+        std::fprintf(stderr, "warning: could not pin to cpu %d\n", options.cpu);
+    }
+
+    std::vector<Result> results;
+    for (const auto& entry : registry()) {
+        if (options.filter && entry.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        Result result{entry.name, calibrate(entry, options.minTimeMs), {}, {}};
+        for (int i = 0; i < options.warmup; i++) {
+            runOnce(entry, result.iterations, nullptr);
+        }
+        for (int i = 0; i < options.repetitions; i++) {
+            result.samples.push_back(runOnce(entry, result.iterations, &result));
+        }
+
+        std::fprintf(stderr, "%-48s %12.1f ns/iter (median of %d)\n", entry.name.c_str(),
+                     percentile(result.samples, 0.5) / result.iterations, options.repetitions);
+        results.push_back(std::move(result));
+    }
+
+    FILE* file = stdout;
+    if (options.output) {
+        file = std::fopen(options.output, "w");
+        if (!file) {
+            std::fprintf(stderr, "error: could not open %s\n", options.output);
+            return 1;
+        }
+    }
+    writeJson(file, options, results);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
+
+}  // namespace bench
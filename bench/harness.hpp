@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+template <class T>
+inline void doNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class State {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    class Iterator {
+      public:
+        Iterator(State* state, uint64_t remaining) : m_state(state), m_remaining(remaining){};
+
+        bool operator!=(const Iterator&) {
+            if (m_remaining > 0) {
+                return true;
+            }
+            m_state->stop();
+            return false;
+        }
+
+        void operator++() {
+            --m_remaining;
+        }
+
+        int operator*() const {
+            return 0;
+        }
+
+      private:
+        State* m_state;
+        uint64_t m_remaining;
+    };
+
+    State(uint64_t iterations) : m_iterations(iterations){};
+
+    Iterator begin() {
+        m_start = Clock::now();
+        return {this, m_iterations};
+    }
+
+    Iterator end() {
+        return {this, 0};
+    }
+
+    uint64_t iterations() const {
+        return m_iterations;
+    }
+
+    // Excludes the code between pause() and resume() from the measured time
+    void pause() {
+        m_elapsed += Clock::now() - m_start;
+    }
+
+    void resume() {
+        m_start = Clock::now();
+    }
+
+    // Attaches a named value to the result, the last repetition wins
+    void counter(const char* name, double value);
+
+    std::chrono::nanoseconds elapsed() const {
+        return m_elapsed;
+    }
+
+    const std::vector<std::pair<std::string, double>>& counters() const {
+        return m_counters;
+    }
+
+  private:
+    void stop() {
+        m_elapsed += Clock::now() - m_start;
+    }
+
+    uint64_t m_iterations;
+    Clock::time_point m_start;
+    std::chrono::nanoseconds m_elapsed{0};
+    std::vector<std::pair<std::string, double>> m_counters;
+};
+
+using Function = std::function<void(State&)>;
+
+void add(std::string name, Function function);
+
+struct Options {
+    int warmup = 2;
+    int repetitions = 10;
+    double minTimeMs = 50.0;
+    int cpu = -1;
+    const char* filter = nullptr;
+    const char* output = nullptr;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options);
+
+int run(const Options& options);
+
+struct Registrar {
+    Registrar(const char* name, Function function) {
+        add(name, std::move(function));
+    }
+};
+
+}  // namespace bench
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+#define BENCHMARK(name, fn) \
+    static ::bench::Registrar BENCH_CONCAT(s_benchRegistrar, __LINE__)(name, fn)
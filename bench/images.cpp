@@ -0,0 +1,121 @@
+#include "images.hpp"
+
+#include "resources.hpp"
+
+namespace {
+
+namespace Images = Resources::Images;
+
+// Every image in src/resources.hpp
+const std::span<const uint8_t> s_images[] = {
+    Images::Backgrounds::Tile_0000, Images::Backgrounds::Tile_0001, Images::Backgrounds::Tile_0002,
+    Images::Backgrounds::Tile_0003, Images::Backgrounds::Tile_0004, Images::Backgrounds::Tile_0005,
+    Images::Backgrounds::Tile_0006, Images::Backgrounds::Tile_0007, Images::Backgrounds::Tile_0008,
+    Images::Backgrounds::Tile_0009, Images::Backgrounds::Tile_0010, Images::Backgrounds::Tile_0011,
+    Images::Backgrounds::Tile_0012, Images::Backgrounds::Tile_0013, Images::Backgrounds::Tile_0014,
+    Images::Backgrounds::Tile_0015, Images::Backgrounds::Tile_0016, Images::Backgrounds::Tile_0017,
+    Images::Backgrounds::Tile_0018, Images::Backgrounds::Tile_0019, Images::Backgrounds::Tile_0020,
+    Images::Backgrounds::Tile_0021, Images::Backgrounds::Tile_0022, Images::Backgrounds::Tile_0023,
+    Images::Characters::Tile_0000, Images::Characters::Tile_0001, Images::Characters::Tile_0002,
+    Images::Characters::Tile_0003, Images::Characters::Tile_0004, Images::Characters::Tile_0005,
+    Images::Characters::Tile_0006, Images::Characters::Tile_0007, Images::Characters::Tile_0008,
+    Images::Characters::Tile_0009, Images::Characters::Tile_0010, Images::Characters::Tile_0011,
+    Images::Characters::Tile_0012, Images::Characters::Tile_0013, Images::Characters::Tile_0014,
+    Images::Characters::Tile_0015, Images::Characters::Tile_0016, Images::Characters::Tile_0017,
+    Images::Characters::Tile_0018, Images::Characters::Tile_0019, Images::Characters::Tile_0020,
+    Images::Characters::Tile_0021, Images::Characters::Tile_0022, Images::Characters::Tile_0023,
+    Images::Characters::Tile_0024, Images::Characters::Tile_0025, Images::Characters::Tile_0026,
+    Images::Player::Player, Images::Tiles::Backgrounds::Tile_0000,
+    Images::Tiles::Backgrounds::Tile_0001, Images::Tiles::Backgrounds::Tile_0002,
+    Images::Tiles::Backgrounds::Tile_0003, Images::Tiles::Backgrounds::Tile_0004,
+    Images::Tiles::Backgrounds::Tile_0005, Images::Tiles::Backgrounds::Tile_0006,
+    Images::Tiles::Backgrounds::Tile_0007, Images::Tiles::Backgrounds::Tile_0008,
+    Images::Tiles::Backgrounds::Tile_0009, Images::Tiles::Backgrounds::Tile_0010,
+    Images::Tiles::Backgrounds::Tile_0011, Images::Tiles::Backgrounds::Tile_0012,
+    Images::Tiles::Backgrounds::Tile_0013, Images::Tiles::Backgrounds::Tile_0014,
+    Images::Tiles::Backgrounds::Tile_0015, Images::Tiles::Backgrounds::Tile_0016,
+    Images::Tiles::Backgrounds::Tile_0017, Images::Tiles::Backgrounds::Tile_0018,
+    Images::Tiles::Backgrounds::Tile_0019, Images::Tiles::Backgrounds::Tile_0020,
+    Images::Tiles::Backgrounds::Tile_0021, Images::Tiles::Backgrounds::Tile_0022,
+    Images::Tiles::Backgrounds::Tile_0023, Images::Tiles::Characters::Tile_0000,
+    Images::Tiles::Characters::Tile_0001, Images::Tiles::Characters::Tile_0002,
+    Images::Tiles::Characters::Tile_0003, Images::Tiles::Characters::Tile_0004,
+    Images::Tiles::Characters::Tile_0005, Images::Tiles::Characters::Tile_0006,
+    Images::Tiles::Characters::Tile_0007, Images::Tiles::Characters::Tile_0008,
+    Images::Tiles::Characters::Tile_0009, Images::Tiles::Characters::Tile_0010,
+    Images::Tiles::Characters::Tile_0011, Images::Tiles::Characters::Tile_0012,
+    Images::Tiles::Characters::Tile_0013, Images::Tiles::Characters::Tile_0014,
+    Images::Tiles::Characters::Tile_0015, Images::Tiles::Characters::Tile_0016,
+    Images::Tiles::Characters::Tile_0017, Images::Tiles::Characters::Tile_0018,
+    Images::Tiles::Characters::Tile_0019, Images::Tiles::Characters::Tile_0020,
+    Images::Tiles::Characters::Tile_0021, Images::Tiles::Characters::Tile_0022,
+    Images::Tiles::Characters::Tile_0023, Images::Tiles::Characters::Tile_0024,
+    Images::Tiles::Characters::Tile_0025, Images::Tiles::Characters::Tile_0026,
+    Images::Tiles::Small, Images::Tiles::Tile_0000, Images::Tiles::Tile_0001,
+    Images::Tiles::Tile_0002, Images::Tiles::Tile_0003, Images::Tiles::Tile_0004,
+    Images::Tiles::Tile_0005, Images::Tiles::Tile_0006, Images::Tiles::Tile_0007,
+    Images::Tiles::Tile_0008, Images::Tiles::Tile_0009, Images::Tiles::Tile_0010,
+    Images::Tiles::Tile_0011, Images::Tiles::Tile_0012, Images::Tiles::Tile_0013,
+    Images::Tiles::Tile_0014, Images::Tiles::Tile_0015, Images::Tiles::Tile_0016,
+    Images::Tiles::Tile_0017, Images::Tiles::Tile_0018, Images::Tiles::Tile_0019,
+    Images::Tiles::Tile_0020, Images::Tiles::Tile_0021, Images::Tiles::Tile_0022,
+    Images::Tiles::Tile_0023, Images::Tiles::Tile_0024, Images::Tiles::Tile_0025,
+    Images::Tiles::Tile_0026, Images::Tiles::Tile_0027, Images::Tiles::Tile_0028,
+    Images::Tiles::Tile_0029, Images::Tiles::Tile_0030, Images::Tiles::Tile_0031,
+    Images::Tiles::Tile_0032, Images::Tiles::Tile_0033, Images::Tiles::Tile_0034,
+    Images::Tiles::Tile_0035, Images::Tiles::Tile_0036, Images::Tiles::Tile_0037,
+    Images::Tiles::Tile_0038, Images::Tiles::Tile_0039, Images::Tiles::Tile_0040,
+    Images::Tiles::Tile_0041, Images::Tiles::Tile_0042, Images::Tiles::Tile_0043,
+    Images::Tiles::Tile_0044, Images::Tiles::Tile_0045, Images::Tiles::Tile_0046,
+    Images::Tiles::Tile_0047, Images::Tiles::Tile_0048, Images::Tiles::Tile_0049,
+    Images::Tiles::Tile_0050, Images::Tiles::Tile_0051, Images::Tiles::Tile_0052,
+    Images::Tiles::Tile_0053, Images::Tiles::Tile_0054, Images::Tiles::Tile_0055,
+    Images::Tiles::Tile_0056, Images::Tiles::Tile_0057, Images::Tiles::Tile_0058,
+    Images::Tiles::Tile_0059, Images::Tiles::Tile_0060, Images::Tiles::Tile_0061,
+    Images::Tiles::Tile_0062, Images::Tiles::Tile_0063, Images::Tiles::Tile_0064,
+    Images::Tiles::Tile_0065, Images::Tiles::Tile_0066, Images::Tiles::Tile_0067,
+    Images::Tiles::Tile_0068, Images::Tiles::Tile_0069, Images::Tiles::Tile_0070,
+    Images::Tiles::Tile_0071, Images::Tiles::Tile_0072, Images::Tiles::Tile_0073,
+    Images::Tiles::Tile_0074, Images::Tiles::Tile_0075, Images::Tiles::Tile_0076,
+    Images::Tiles::Tile_0077, Images::Tiles::Tile_0078, Images::Tiles::Tile_0079,
+    Images::Tiles::Tile_0080, Images::Tiles::Tile_0081, Images::Tiles::Tile_0082,
+    Images::Tiles::Tile_0083, Images::Tiles::Tile_0084, Images::Tiles::Tile_0085,
+    Images::Tiles::Tile_0086, Images::Tiles::Tile_0087, Images::Tiles::Tile_0088,
+    Images::Tiles::Tile_0089, Images::Tiles::Tile_0090, Images::Tiles::Tile_0091,
+    Images::Tiles::Tile_0092, Images::Tiles::Tile_0093, Images::Tiles::Tile_0094,
+    Images::Tiles::Tile_0095, Images::Tiles::Tile_0096, Images::Tiles::Tile_0097,
+    Images::Tiles::Tile_0098, Images::Tiles::Tile_0099, Images::Tiles::Tile_0100,
+    Images::Tiles::Tile_0101, Images::Tiles::Tile_0102, Images::Tiles::Tile_0103,
+    Images::Tiles::Tile_0104, Images::Tiles::Tile_0105, Images::Tiles::Tile_0106,
+    Images::Tiles::Tile_0107, Images::Tiles::Tile_0108, Images::Tiles::Tile_0109,
+    Images::Tiles::Tile_0110, Images::Tiles::Tile_0111, Images::Tiles::Tile_0112,
+    Images::Tiles::Tile_0113, Images::Tiles::Tile_0114, Images::Tiles::Tile_0115,
+    Images::Tiles::Tile_0116, Images::Tiles::Tile_0117, Images::Tiles::Tile_0118,
+    Images::Tiles::Tile_0119, Images::Tiles::Tile_0120, Images::Tiles::Tile_0121,
+    Images::Tiles::Tile_0122, Images::Tiles::Tile_0123, Images::Tiles::Tile_0124,
+    Images::Tiles::Tile_0125, Images::Tiles::Tile_0126, Images::Tiles::Tile_0127,
+    Images::Tiles::Tile_0128, Images::Tiles::Tile_0129, Images::Tiles::Tile_0130,
+    Images::Tiles::Tile_0131, Images::Tiles::Tile_0132, Images::Tiles::Tile_0133,
+    Images::Tiles::Tile_0134, Images::Tiles::Tile_0135, Images::Tiles::Tile_0136,
+    Images::Tiles::Tile_0137, Images::Tiles::Tile_0138, Images::Tiles::Tile_0139,
+    Images::Tiles::Tile_0140, Images::Tiles::Tile_0141, Images::Tiles::Tile_0142,
+    Images::Tiles::Tile_0143, Images::Tiles::Tile_0144, Images::Tiles::Tile_0145,
+    Images::Tiles::Tile_0146, Images::Tiles::Tile_0147, Images::Tiles::Tile_0148,
+    Images::Tiles::Tile_0149, Images::Tiles::Tile_0150, Images::Tiles::Tile_0151,
+    Images::Tiles::Tile_0152, Images::Tiles::Tile_0153, Images::Tiles::Tile_0154,
+    Images::Tiles::Tile_0155, Images::Tiles::Tile_0156, Images::Tiles::Tile_0157,
+    Images::Tiles::Tile_0158, Images::Tiles::Tile_0159, Images::Tiles::Tile_0160,
+    Images::Tiles::Tile_0161, Images::Tiles::Tile_0162, Images::Tiles::Tile_0163,
+    Images::Tiles::Tile_0164, Images::Tiles::Tile_0165, Images::Tiles::Tile_0166,
+    Images::Tiles::Tile_0167, Images::Tiles::Tile_0168, Images::Tiles::Tile_0169,
+    Images::Tiles::Tile_0170, Images::Tiles::Tile_0171, Images::Tiles::Tile_0172,
+    Images::Tiles::Tile_0173, Images::Tiles::Tile_0174, Images::Tiles::Tile_0175,
+    Images::Tiles::Tile_0176, Images::Tiles::Tile_0177, Images::Tiles::Tile_0178,
+    Images::Tiles::Tile_0179,
+};
+
+}  // namespace
+
+std::span<const std::span<const uint8_t>> bench::embeddedImages() {
+    return s_images;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace bench {
+
+// All embedded Resources::Images, for benchmarks over the whole asset set
+std::span<const std::span<const uint8_t>> embeddedImages();
+
+}  // namespace bench
@@ -0,0 +1,26 @@
+#include <SDL3/SDL.h>
+
+#include "harness.hpp"
+#include "lib/logger.hpp"
+#include "lib/resource_loader.hpp"
+
+int main(int argc, char* argv[]) {
+    bench::Options options;
+    if (!bench::parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    if (SDL_Init(0)) {
+        SDL_LogError(SDL_LOG_CATEGORY_CUSTOM, "Error %s", SDL_GetError());
+        return 1;
+    }
+
+    Log::init();
+    ResourceLoader::init();
+    int status = bench::run(options);
+    ResourceLoader::shutdown();
+    Log::shutdown();
+
+    SDL_Quit();
+    return status;
+}
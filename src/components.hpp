@@ -0,0 +1,962 @@
+#pragma once
+
+#include <array>
+#include <box2d/box2d.h>
+#include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "lib.hpp"
+#include "lib/box2d_debug.hpp"
+
+#include "world.hpp"
+
+class GameObject;
+class Component;
+
+namespace Components {
+namespace Tags {
+constexpr int BEHAVIOUR = 10;
+constexpr int PHYSICS = 20;
+}  // namespace Tags
+}  // namespace Components
+template <>
+struct std::equal_to<b2ShapeId> {
+    constexpr bool operator()(const b2ShapeId& lhs, const b2ShapeId& rhs) const {
+        return B2_ID_EQUALS(lhs, rhs);
+    }
+};
+
+template <>
+struct std::hash<b2ShapeId> {
+    std::size_t operator()(const b2ShapeId& s) const noexcept {
+        auto h = reinterpret_cast<const uint64_t*>(&s);
+        return *h;
+    }
+};
+class Component {
+  public:
+    Component() = default;
+    virtual ~Component() = default;
+    Component(const Component&) = delete;
+    Component(Component&&) = default;
+    Component& operator=(const Component& other) = delete;
+    Component& operator=(Component&& other) = default;
+
+    void setGameObject(GameObject* gameObject) {
+        m_gameObject = gameObject;
+    };
+
+    GameObject& getGameObject() {
+        return *m_gameObject;
+    }
+
+    const GameObject& getGameObject() const {
+        return *m_gameObject;
+    }
+
+    virtual void init(GameContext& context) {};
+    virtual void deinit(GameContext& context) {};
+    virtual void update(GameContext& context, UpdateContext& updateContext) {};
+    virtual void render(RenderContext& context) {};
+
+    int getTag() const {
+        return m_tag;
+    }
+    void setTag(int tag) {
+        m_tag = tag;
+    }
+
+  private:
+    // TODO: Replace ptr with id
+    GameObject* m_gameObject = nullptr;
+    int m_tag = 0;
+};
+
+class GameObject {
+  public:
+    GameObject() : m_id(++s_lastId) {
+    }
+    ~GameObject() = default;
+    GameObject(const GameObject&) = delete;
+    GameObject(GameObject&& other) noexcept
+        : m_components(std::move(other.m_components)),
+          m_id(other.m_id),
+          m_removed(other.m_removed),
+          m_transform(other.m_transform) {
+        bindComponents();
+    }
+    GameObject& operator=(const GameObject& other) = delete;
+    GameObject& operator=(GameObject&& other) noexcept {
+        m_components = std::move(other.m_components);
+        m_id = other.m_id;
+        m_removed = other.m_removed;
+        m_transform = other.m_transform;
+        bindComponents();
+        return *this;
+    }
+
+    void update(GameContext& context, UpdateContext& updateContext) {
+        for (auto& component : m_components) {
+            Q14_COMPONENT_SCOPE(typeid(*component), Update);
+            component->update(context, updateContext);
+        }
+    };
+
+    void render(RenderContext& context) {
+        context.pushTransform(m_transform);
+        for (auto& component : m_components) {
+            Q14_COMPONENT_SCOPE(typeid(*component), Render);
+            component->render(context);
+        }
+        context.popTransform();
+    };
+
+    void init(GameContext& context) {
+        for (size_t i = 0; i < m_components.size(); i++) {
+            auto component = m_components[i].get();
+            component->setGameObject(this);
+            component->init(context);
+        }
+    };
+
+    void deinit(GameContext& context) {
+        for (auto& component : m_components) {
+            component->deinit(context);
+            component->setGameObject(nullptr);
+        }
+    }
+
+    template <class T>
+    T* addComponent(std::unique_ptr<T> component) {
+        auto ptr = component.get();
+        ptr->setGameObject(this);
+        m_components.push_back(std::move(component));
+        return ptr;
+    };
+
+    template <class T>
+    T* addComponent(std::unique_ptr<T> component, int tag) {
+        component->setTag(tag);
+        return addComponent(std::move(component));
+    };
+
+    Component* getComponentByTag(int tag) {
+        auto it = std::find_if(m_components.begin(), m_components.end(),
+                               [tag](const auto& c) { return c->getTag() == tag; });
+        if (it != m_components.end()) {
+            return it->get();
+        }
+        return nullptr;
+    }
+
+    const Component* getComponentByTag(int tag) const {
+        auto it = std::find_if(m_components.begin(), m_components.end(),
+                               [tag](const auto& c) { return c->getTag() == tag; });
+        if (it != m_components.end()) {
+            return it->get();
+        }
+        return nullptr;
+    }
+
+    void remove() {
+        m_removed = true;
+    };
+
+    bool removed() const {
+        return m_removed;
+    }
+
+    Transform& getTransform() {
+        return m_transform;
+    }
+    const Transform& getTransform() const {
+        return m_transform;
+    }
+
+    std::span<const std::unique_ptr<Component>> getComponents() const {
+        return m_components;
+    }
+
+    // Unique for the run and kept when the object moves, unlike its address or index
+    uint64_t getId() const {
+        return m_id;
+    }
+
+  private:
+    // Components keep a pointer back to their object, which changes whenever the owning
+    // vector grows or compacts, so it has to follow the object when moved
+    void bindComponents() {
+        for (auto& component : m_components) {
+            component->setGameObject(this);
+        }
+    }
+
+    // Objects are created on the main thread only
+    static inline uint64_t s_lastId = 0;
+
+    std::vector<std::unique_ptr<Component>> m_components;
+    uint64_t m_id;
+    bool m_removed = false;
+    Transform m_transform;
+};
+class PhysicsBodyComponent : public Component {
+  public:
+    using Callback = std::function<void(PhysicsBodyComponent&, PhysicsBodyComponent&)>;
+
+  private:
+    struct Sensor {
+        int collisions = 0;
+    };
+
+  public:
+    PhysicsBodyComponent(b2BodyId id) : m_id(id){};
+    virtual ~PhysicsBodyComponent() {
+    }
+
+    b2ShapeId addShape(b2ShapeDef shapeDef, b2Polygon polygon) {
+        auto shapeId = b2CreatePolygonShape(m_id, &shapeDef, &polygon);
+        if (shapeDef.isSensor) {
+            m_sensors.emplace(shapeId, Sensor{});
+        }
+        b2Shape_SetUserData(shapeId, this);
+        return shapeId;
+    }
+
+    b2ShapeId addShape(b2ShapeDef shapeDef, b2Circle circle) {
+        auto shapeId = b2CreateCircleShape(m_id, &shapeDef, &circle);
+        if (shapeDef.isSensor) {
+            m_sensors.emplace(shapeId, Sensor{});
+        }
+        b2Shape_SetUserData(shapeId, this);
+        return shapeId;
+    }
+
+    void onCollisionBegan(PhysicsBodyComponent& other) {
+        if (m_collisionBegan) {
+            m_collisionBegan(*this, other);
+        }
+    };
+
+    void onCollisionEnded(PhysicsBodyComponent& other) {
+        if (m_collisionEnded) {
+            m_collisionEnded(*this, other);
+        }
+    };
+
+    void onSensorCollisionBegan(b2ShapeId id) {
+        getSensor(id).collisions++;
+    };
+
+    void onSensorCollisionEnded(b2ShapeId id) {
+        getSensor(id).collisions--;
+    };
+
+    Sensor& getSensor(b2ShapeId id) {
+        return m_sensors[id];
+    }
+
+    bool isSensorInCollision(b2ShapeId id) const {
+        auto it = m_sensors.find(id);
+        return it != m_sensors.end() && it->second.collisions > 0;
+    }
+    void init(GameContext& context) override {
+        onMove(getPosition(), 0);
+    }
+
+    void deinit(GameContext& context) override {
+        if (!B2_ID_EQUALS(m_id, b2_nullBodyId)) {
+            b2DestroyBody(m_id);
+            m_id = b2_nullBodyId;
+        }
+    };
+
+    void onMove(Vec2 center, float rotation) {
+        getGameObject().getTransform().setPosition(center);
+        getGameObject().getTransform().setRotation(rotation);
+    };
+
+    void applyForce(Vec2 force) {
+        b2Body_ApplyForceToCenter(m_id, {force.x, force.y}, true);
+    }
+
+    void applyImpulse(Vec2 force) {
+        b2Body_ApplyLinearImpulseToCenter(m_id, {force.x, force.y}, true);
+    }
+
+    Vec2 getLinearVelocity() const {
+        b2Vec2 velocity = b2Body_GetLinearVelocity(m_id);
+        return {velocity.x, velocity.y};
+    }
+
+    Vec2 getPosition() const {
+        auto position = b2Body_GetPosition(m_id);
+        return {position.x, position.y};
+    }
+
+    void setPosition(Vec2 position) {
+        auto angle = b2Body_GetAngle(m_id);
+        b2Body_SetTransform(m_id, {position.x, position.y}, angle);
+    }
+
+    float getMass() const {
+        return b2Body_GetMass(m_id);
+    }
+
+    float getFriction() const {
+        return b2Shape_GetFriction(getShape());
+    }
+
+    void setFriction(float f) {
+        b2Shape_SetFriction(getShape(), f);
+    }
+
+    void setCollisionListener(Callback&& callback) {
+        m_collisionBegan = callback;
+    }
+
+  private:
+    b2ShapeId getShape() const {
+        b2ShapeId shapes = b2_nullShapeId;
+        b2Body_GetShapes(m_id, &shapes, 1);
+        return shapes;
+    }
+
+    b2BodyId m_id;
+    std::unordered_map<b2ShapeId, Sensor> m_sensors;
+
+  public:
+    Callback m_collisionBegan = {};
+    Callback m_collisionEnded = {};
+};
+
+class Sprite : public Component {
+  public:
+    static std::unique_ptr<Sprite> create(Texture texture) {
+        auto sprite = std::make_unique<Sprite>();
+        TextureRect rect{texture, {{0, 0}, {texture.width, texture.height}}};
+        sprite->setTextureRect(rect);
+        return sprite;
+    }
+
+    void setTextureRect(TextureRect textureRect) {
+        m_textureRect = textureRect;
+    }
+
+    void setFlipX(bool flipX) {
+        m_flipX = flipX;
+    }
+
+    void render(RenderContext& context) override {
+        context.setTexture(m_textureRect.texture);
+        Mat3 mat = Mat3(1.0f);
+        mat[0][0] = m_flipX ? 1.0f : -1.0f;
+        context.drawTexture(m_contentRect, m_textureRect.normalizedBounds(), mat);
+    };
+
+    void setSize(Size size) {
+        m_contentRect.size = size;
+    }
+    Size getSize() const {
+        return m_contentRect.size;
+    };
+
+    void setOrigin(Vec2 origin) {
+        m_contentRect.origin = origin;
+    }
+
+  private:
+    Rect m_contentRect{{-0.5f, -0.5f}, {1.0f, 1.0f}};
+    TextureRect m_textureRect;
+    bool m_flipX = false;
+};
+
+class TrailRendererComponent : public Component {
+  public:
+    // static std::unique_ptr<Sprite> create(Texture texture) {
+    //     auto sprite = std::make_unique<Sprite>();
+    //     TextureRect rect{texture, {{0, 0}, {texture.width, texture.height}}};
+    //     sprite->setTextureRect(rect);
+    //     return sprite;
+    // }
+
+    void init(GameContext& context) override {
+        m_history.fill(getGameObject().getTransform().getPosition());
+    }
+
+    void update(GameContext& context, UpdateContext& updateContext) override {
+        m_head = (m_head + 1) % TRAIL_LENGTH;
+        m_history[m_head] = getGameObject().getTransform().getPosition();
+    };
+
+    void render(RenderContext& context) override {
+        // Newest to oldest, relative to the object and fading out
+        std::array<Vertex, TRAIL_LENGTH> trail;
+        auto position = m_history[m_head];
+        for (size_t i = 0; i < TRAIL_LENGTH; i++) {
+            auto& vertex = trail[i];
+            vertex.position = m_history[(m_head + TRAIL_LENGTH - i) % TRAIL_LENGTH] - position;
+            vertex.color = Colors::WHITE;
+            vertex.color.a = static_cast<uint8_t>(255 * (TRAIL_LENGTH - i) / TRAIL_LENGTH);
+        }
+        context.drawPolyline(trail, 2.0f);
+        context.setColor(Colors::WHITE);
+        context.drawPoint({0.0f, 0.0f}, 2.0f);
+        // context.setTexture(m_textureRect.texture);
+        // Mat3 mat = Mat3(1.0f);
+        // mat[0][0] = m_flipX ? 1.0f : -1.0f;
+        // context.drawTexture(m_contentRect, m_textureRect.normalizedBounds(), mat);
+    };
+
+    void setSize(Size size) {
+        m_contentRect.size = size;
+    }
+    Size getSize() const {
+        return m_contentRect.size;
+    };
+
+    void setOrigin(Vec2 origin) {
+        m_contentRect.origin = origin;
+    }
+
+  private:
+    static constexpr size_t TRAIL_LENGTH = 8;
+
+    Rect m_contentRect{{-0.5f, -0.5f}, {1.0f, 1.0f}};
+    std::array<Vec2, TRAIL_LENGTH> m_history;
+    size_t m_head = 0;
+};
+
+class PhysicsSystem {
+  public:
+    ~PhysicsSystem() {
+        if (valid()) {
+            reset();
+        }
+    }
+
+    bool valid() const {
+        return m_id.index1 != b2_nullWorldId.index1 || m_id.revision != b2_nullWorldId.revision;
+    }
+
+    void init() {
+        if (valid()) {
+            reset();
+        }
+#ifdef Q14_TRACK_ALLOCATIONS
+        // Box2D allocates through malloc, which the operator new hooks do not see
+        b2SetAllocator(allocate, deallocate);
+#endif
+        b2WorldDef worldDef = b2DefaultWorldDef();
+        worldDef.gravity = {0.0f, 10.0f};
+        m_id = b2CreateWorld(&worldDef);
+    }
+
+    void update(UpdateContext& context) {
+        Q14_PROFILE_SCOPE("PhysicsSystem::update");
+        Q14_MEMORY_SCOPE(Physics);
+        int subStepCount = 4;
+        b2World_Step(m_id, context.getDeltaTime(), subStepCount);
+        {
+            auto profile = getProfile();
+            m_stepHistory[m_historyHead] = profile.step;
+            m_collideHistory[m_historyHead] = profile.collide;
+            m_solveHistory[m_historyHead] = profile.solve;
+            m_continuousHistory[m_historyHead] = profile.continuous;
+            m_historyHead = (m_historyHead + 1) % HISTORY;
+        }
+
+        for (auto& event : getSensorBeginTouchEvents()) {
+            auto userData = b2Shape_GetUserData(event.sensorShapeId);
+            if (!userData) {
+                continue;
+            }
+            // auto visitorUserData = b2Body_GetUserData(b2Shape_GetBody(event.visitorShapeId));
+
+            auto sensor = reinterpret_cast<PhysicsBodyComponent*>(userData);
+            // auto visitor = reinterpret_cast<GameObject*>(visitorUserData);
+            sensor->onSensorCollisionBegan(event.sensorShapeId);
+        };
+
+        for (auto& event : getSensorEndTouchEvents()) {
+            auto userData = b2Shape_GetUserData(event.sensorShapeId);
+            if (!userData) {
+                continue;
+            }
+            // auto visitorUserData = b2Body_GetUserData(b2Shape_GetBody(event.visitorShapeId));
+            auto* sensor = reinterpret_cast<PhysicsBodyComponent*>(userData);
+            // auto visitor = reinterpret_cast<GameObject*>(visitorUserData);
+            sensor->onSensorCollisionEnded(event.sensorShapeId);
+        };
+
+        for (auto& event : getMoveEvents()) {
+            if (event.userData) {
+                auto body = reinterpret_cast<PhysicsBodyComponent*>(event.userData);
+                Vec2 p = {event.transform.p.x, event.transform.p.y};
+                float r = b2Rot_GetAngle(event.transform.q);
+                body->onMove(p, r);
+            }
+        }
+
+        for (auto& event : getBeginTouchEvents()) {
+            auto userDataA = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdA));
+            auto userDataB = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdB));
+
+            auto bodyA = reinterpret_cast<PhysicsBodyComponent*>(userDataA);
+            auto bodyB = reinterpret_cast<PhysicsBodyComponent*>(userDataB);
+
+            bodyA->onCollisionBegan(*bodyB);
+            bodyB->onCollisionBegan(*bodyA);
+        }
+
+        for (auto& event : getEndTouchEvents()) {
+            auto userDataA = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdA));
+            auto userDataB = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdB));
+
+            auto bodyA = reinterpret_cast<PhysicsBodyComponent*>(userDataA);
+            auto bodyB = reinterpret_cast<PhysicsBodyComponent*>(userDataB);
+
+            bodyA->onCollisionEnded(*bodyB);
+            bodyB->onCollisionEnded(*bodyA);
+        }
+
+        for (auto& event : getHitEvents()) {
+            auto userDataA = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdA));
+            auto userDataB = b2Body_GetUserData(b2Shape_GetBody(event.shapeIdB));
+
+            auto bodyA = reinterpret_cast<PhysicsBodyComponent*>(userDataA);
+            auto bodyB = reinterpret_cast<PhysicsBodyComponent*>(userDataB);
+
+            // TODO: this is not correct (:
+            bodyA->onCollisionBegan(*bodyB);
+            bodyB->onCollisionBegan(*bodyA);
+        }
+    };
+
+    void render(RenderContext& context) {
+        Q14_PROFILE_SCOPE("PhysicsSystem::render");
+        m_debugDraw.render(m_id, context);
+    }
+
+    // Timings of the last step in milliseconds, per stage
+    b2Profile getProfile() const {
+        return b2World_GetProfile(m_id);
+    }
+
+    b2Counters getCounters() const {
+        return b2World_GetCounters(m_id);
+    }
+
+    void debug(Debugger& debugger) {
+        if (!debugger.pushSection("PHYSICS")) {
+            return;
+        }
+        auto profile = getProfile();
+        debugger.label("step", "%.3f ms", profile.step);
+        debugger.label("pairs", "%.3f ms", profile.pairs);
+        debugger.label("collide", "%.3f ms", profile.collide);
+        debugger.label("solve", "%.3f ms", profile.solve);
+        debugger.label("continuous", "%.3f ms", profile.continuous);
+
+        auto counters = getCounters();
+        debugger.label("bodies", "%d", counters.bodyCount);
+        debugger.label("contacts", "%d", counters.contactCount);
+        debugger.label("joints", "%d", counters.jointCount);
+        debugger.label("islands", "%d", counters.islandCount);
+        debugger.label("tree height", "%d", counters.treeHeight);
+        debugger.label("stack used", "%d B", counters.stackUsed);
+        debugger.label("memory", "%.1f KiB", counters.byteCount / 1024.0f);
+        debugger.label("tasks", "%d", counters.taskCount);
+
+        debugger.plot("step (ms)", m_stepHistory, m_historyHead);
+        debugger.plot("collide (ms)", m_collideHistory, m_historyHead);
+        debugger.plot("solve (ms)", m_solveHistory, m_historyHead);
+        debugger.plot("continuous (ms)", m_continuousHistory, m_historyHead);
+        debugger.popSection();
+    }
+
+    std::unique_ptr<PhysicsBodyComponent> createBody(b2BodyDef bodyDef) {
+        b2BodyId bodyId = b2CreateBody(m_id, &bodyDef);
+
+        std::unique_ptr<PhysicsBodyComponent> component =
+            std::make_unique<PhysicsBodyComponent>(bodyId);
+        b2Body_SetUserData(bodyId, component.get());
+        return component;
+    }
+
+    std::unique_ptr<PhysicsBodyComponent> createBody(Vec2 position = Vec2(0, 0),
+                                                     b2BodyType type = b2_dynamicBody) {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = type;
+        bodyDef.position = {position.x, position.y};
+        return createBody(bodyDef);
+    }
+
+    std::span<b2BodyMoveEvent> getMoveEvents() {
+        b2BodyEvents events = b2World_GetBodyEvents(m_id);
+        return {events.moveEvents, (size_t)events.moveCount};
+    }
+
+    std::span<b2ContactBeginTouchEvent> getBeginTouchEvents() {
+        b2ContactEvents events = b2World_GetContactEvents(m_id);
+        return {events.beginEvents, (size_t)events.beginCount};
+    }
+
+    std::span<b2ContactEndTouchEvent> getEndTouchEvents() {
+        b2ContactEvents events = b2World_GetContactEvents(m_id);
+        return {events.endEvents, (size_t)events.endCount};
+    }
+
+    std::span<b2ContactHitEvent> getHitEvents() {
+        b2ContactEvents events = b2World_GetContactEvents(m_id);
+        return {events.hitEvents, (size_t)events.hitCount};
+    }
+
+    std::span<b2SensorBeginTouchEvent> getSensorBeginTouchEvents() {
+        b2SensorEvents events = b2World_GetSensorEvents(m_id);
+        return {events.beginEvents, (size_t)events.beginCount};
+    }
+
+    std::span<b2SensorEndTouchEvent> getSensorEndTouchEvents() {
+        b2SensorEvents events = b2World_GetSensorEvents(m_id);
+        return {events.endEvents, (size_t)events.endCount};
+    }
+
+  private:
+    void reset() {
+        b2DestroyWorld(m_id);
+        m_id = b2_nullWorldId;
+    }
+
+#ifdef Q14_TRACK_ALLOCATIONS
+    static void* allocate(unsigned int size, int alignment) {
+        return Memory::allocate(size, alignment, Memory::Tag::Physics);
+    }
+
+    static void deallocate(void* ptr) {
+        Memory::deallocate(ptr);
+    }
+#endif
+
+    static constexpr int HISTORY = 120;
+
+    b2WorldId m_id = b2_nullWorldId;
+    Box2dDebugDraw m_debugDraw;
+
+    std::array<float, HISTORY> m_stepHistory{};
+    std::array<float, HISTORY> m_collideHistory{};
+    std::array<float, HISTORY> m_solveHistory{};
+    std::array<float, HISTORY> m_continuousHistory{};
+    int m_historyHead = 0;
+};
+
+class BehaviourComponent : public Component {
+  public:
+    virtual bool moveLeft() const {
+        return false;
+    };
+    virtual bool moveRight() const {
+        return false;
+    };
+    virtual bool jump() const {
+        return false;
+    };
+    virtual bool primaryAction() const {
+        return false;
+    }
+};
+
+class PlayerBehaviourComponent : public BehaviourComponent {
+  public:
+    void update(GameContext& context, UpdateContext& updateContext) override {
+        m_state = updateContext.getInputState();
+    }
+
+    bool moveLeft() const override {
+        return m_state.left.active();
+    };
+    bool moveRight() const override {
+        return m_state.right.active();
+    };
+    bool jump() const override {
+        return m_state.up.active() || m_state.secondaryAction.active();
+    };
+    bool primaryAction() const override {
+        return m_state.primaryAction.active();
+    };
+
+  private:
+    InputState m_state;
+};
+
+class BulletComponent : public Component {
+  public:
+    void init(GameContext& context) override {
+        auto& obj = getGameObject();
+        auto pc =
+            static_cast<PhysicsBodyComponent*>(obj.getComponentByTag(Components::Tags::PHYSICS));
+        pc->setCollisionListener([](PhysicsBodyComponent& self, PhysicsBodyComponent& other) {
+            // TODO: TEMP
+            self.getGameObject().remove();
+            if (other.getGameObject().getComponentByTag(Components::Tags::BEHAVIOUR)) {
+                other.getGameObject().remove();
+            }
+        });
+    }
+};
+
+inline GameObject& createBullet(GameContext& context, Vec2 position, Vec2 force) {
+    auto& obj = context.createObject();
+
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.position = {position.x, position.y};
+    bodyDef.fixedRotation = true;
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.isBullet = true;
+    bodyDef.gravityScale = 0.0f;
+    b2Circle circle{{0.0f, 0.0f}, 0.01f};
+
+    b2ShapeDef shapeDef = b2DefaultShapeDef();
+    shapeDef.density = 1.0f;
+    shapeDef.friction = 0.0f;
+    shapeDef.restitution = 0.0f;
+
+    auto pc = obj.addComponent(context.physics->createBody(bodyDef), Components::Tags::PHYSICS);
+    pc->addShape(shapeDef, circle);
+    pc->applyForce(force);
+
+    obj.addComponent(std::make_unique<BulletComponent>());
+    obj.addComponent(std::make_unique<TrailRendererComponent>());
+    return obj;
+}
+
+class EnemyBehaviourComponent : public BehaviourComponent {
+  public:
+    bool moveLeft() const override {
+        return false;
+    };
+    bool moveRight() const override {
+        const PhysicsBodyComponent* body = static_cast<const PhysicsBodyComponent*>(
+            getGameObject().getComponentByTag(Components::Tags::PHYSICS));
+        return math::is_zero(body->getLinearVelocity().y);
+    };
+    bool jump() const override {
+        return false;  // math::random(0.0, 1.0) > 0.75;
+    };
+};
+
+class DelayedCondition {
+  public:
+    DelayedCondition() = default;
+    DelayedCondition(uint64_t interval) : m_interval(interval){};
+
+    bool operator()(bool condition, uint64_t ticks) {
+        return condition && available(ticks);
+    };
+
+  private:
+    bool available(uint64_t ticks) {
+        if (ticks - m_lastTick > m_interval) {
+            m_lastTick = ticks;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t m_lastTick = 0;
+    uint64_t m_interval = 600;
+};
+
+// TODO: rename
+class PlayerComponent : public Component {
+  public:
+    void init(GameContext& context) override {
+        m_behaviour = static_cast<BehaviourComponent*>(
+            getGameObject().getComponentByTag(Components::Tags::BEHAVIOUR));
+        if (!m_behaviour) {
+            m_behaviour = getGameObject().addComponent(std::make_unique<BehaviourComponent>());
+        }
+        {
+            const auto& p = getGameObject().getTransform().getPosition();
+            b2BodyDef bodyDef = b2DefaultBodyDef();
+            bodyDef.position = {p.x, p.y};
+            bodyDef.fixedRotation = true;
+            bodyDef.type = b2_dynamicBody;
+
+            m_physics = getGameObject().addComponent(context.physics->createBody(bodyDef),
+                                                     Components::Tags::PHYSICS);
+        }
+
+        {
+            b2Polygon polygon = b2MakeBox(0.25f, 0.5f);
+            b2ShapeDef shapeDef = b2DefaultShapeDef();
+            shapeDef.density = 1.0f;
+            shapeDef.friction = 1.0f;
+            shapeDef.restitution = 0.0f;
+
+            m_physics->addShape(shapeDef, polygon);
+        }
+
+        {
+            b2ShapeDef shapeDef = b2DefaultShapeDef();
+            shapeDef.isSensor = true;
+
+            b2Polygon polygon = b2MakeOffsetBox(0.15f, 0.05f, {0, 0.5f}, 0);
+            m_bottomSensor = m_physics->addShape(shapeDef, polygon);
+
+            polygon = b2MakeOffsetBox(0.15f, 0.05f, {0, -0.5f}, 0);
+            m_topSensor = m_physics->addShape(shapeDef, polygon);
+
+            polygon = b2MakeOffsetBox(0.05f, 0.45f, {0.25f, 0}, 0);
+            m_rightSensor = m_physics->addShape(shapeDef, polygon);
+
+            polygon = b2MakeOffsetBox(0.05f, 0.45f, {-0.25f, 0}, 0);
+            m_leftSensor = m_physics->addShape(shapeDef, polygon);
+        }
+    }
+
+    b2ShapeId m_bottomSensor;
+    b2ShapeId m_topSensor;
+    b2ShapeId m_leftSensor;
+    b2ShapeId m_rightSensor;
+
+    bool onGround() {
+        return body().isSensorInCollision(m_bottomSensor);
+    }
+
+    bool onLeftWall() const {
+        return body().isSensorInCollision(m_leftSensor);
+    }
+
+    bool onRightWall() const {
+        return body().isSensorInCollision(m_rightSensor);
+    }
+
+    bool onWall() const {
+        return onLeftWall() || onRightWall();
+    }
+
+    void update(GameContext& context, UpdateContext& updateContext) override {
+        const float MAX_VELOCITY = 5.0f;
+        const float VELOCITY_FORCE = 50.0f;
+
+        // auto input = context.getInputState();
+
+        const auto velocity = body().getLinearVelocity();
+
+        bool walking = behaviour().moveLeft() || behaviour().moveRight();
+        bool jump = behaviour().jump();
+        bool pushingLeftWall = onLeftWall() && behaviour().moveLeft();
+        bool pushingRightWall = onRightWall() && behaviour().moveRight();
+
+        // TODO: "delayed boolean"
+        // pushingRightWall = delayed(onRightWall() && moveRight(), 0.5s);
+        // if statement has been true for 0.5s or more, return true
+
+        bool pushingWall = pushingLeftWall || pushingRightWall;
+
+        float friction = body().getFriction();
+        if (onGround()) {
+            friction = 1.0f;
+        } else if (onWall()) {
+            friction = 0.5f;
+        }
+        body().setFriction(friction);
+
+        if (!walking) {
+            const float T = 0.1f;
+            float x = 0.0f;
+            if (velocity.x < -T) {
+                x = 10.0f;
+            } else if (velocity.x > T) {
+                x = -10.0f;
+            }
+            body().applyForce({x, 0.0f});
+        } else {
+            float force = VELOCITY_FORCE;
+            if (onGround()) {
+            } else if (onWall()) {
+                force *= 0.1f;
+            } else {
+                // force *= 0.5f;
+            }
+            // b2Shape_SetFriction(m_shapeId, walking ? 0 : 1);
+            if (behaviour().moveLeft() && velocity.x > -MAX_VELOCITY) {
+                // SDL_Log("left: %f", velocity.x);
+                body().applyForce({-force, 0.0f});
+            }
+            if (behaviour().moveRight() && velocity.x < MAX_VELOCITY) {
+                // SDL_Log("right: %f", velocity.x);
+                body().applyForce({force, 0.0f});
+                // b2Body_ApplyLinearImpulseToCenter(m_bodyId, {1, 0}, true);
+            }
+        }
+        if (jump && !isJumping && (onGround() || pushingWall)) {
+            isJumping = true;
+            jumpDirection = 0;
+            jumpTicks = 3;
+            Q14_LOG_DEBUG("Jump begin");
+        }
+        if (jump && jumpTicks > 0) {
+            --jumpTicks;
+            // SDL_Log("up");
+
+            float force = body().getMass() * 2 / (1 / 60.0f);
+            float forceX = 0;
+            if (pushingLeftWall || jumpDirection < 0.0f) {
+                forceX = force;
+                jumpDirection = -1;
+            } else if (pushingRightWall || jumpDirection > 0.0f) {
+                forceX = -force;
+                jumpDirection = 1;
+            }
+            body().applyForce({forceX, -force});
+            Q14_LOG_TRACE("Jump tick %d", jumpTicks);
+
+            // b2Body_ApplyLinearImpulseToCenter(m_bodyId, {0, -4}, true);
+        } else if (isJumping) {
+            isJumping = false;
+            jumpTicks = 0;
+            jumpDirection = 0;
+            Q14_LOG_DEBUG("Jump end");
+        }
+
+        if (m_primaryAction(behaviour().primaryAction(), updateContext.getTicks())) {
+            Q14_LOG_DEBUG("Fire");
+            const auto& p = getGameObject().getTransform().getPosition();
+            createBullet(context, {p.x + 1.0f, p.y}, {1.0f, context.random->range(-0.1f, 0.1f)});
+        }
+
+        if (m_sprite) {
+            if (behaviour().moveLeft()) {
+                m_sprite->setFlipX(true);
+            } else if (behaviour().moveRight()) {
+                m_sprite->setFlipX(!true);
+            }
+        }
+    };
+
+    DelayedCondition m_primaryAction;
+
+    PhysicsBodyComponent& body() {
+        return *m_physics;
+    }
+
+    const PhysicsBodyComponent& body() const {
+        return *m_physics;
+    }
+
+    const BehaviourComponent& behaviour() const {
+        return *m_behaviour;
+    }
+
+    PhysicsBodyComponent* m_physics = nullptr;
+    BehaviourComponent* m_behaviour = nullptr;
+    Sprite* m_sprite = nullptr;
+
+    bool isJumping = false;
+    int jumpTicks = 0;
+    int jumpDirection = 0;
+};
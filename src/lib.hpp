@@ -1,11 +1,23 @@
 #pragma once
 
 #include "lib/app.hpp"
+#include "lib/archive.hpp"
 #include "lib/color.hpp"
+#include "lib/component_stats.hpp"
 #include "lib/event.hpp"
+#include "lib/flight_recorder.hpp"
 #include "lib/gfx.hpp"
+#include "lib/image_cache.hpp"
 #include "lib/input.hpp"
+#include "lib/input_recorder.hpp"
+#include "lib/logger.hpp"
 #include "lib/math.hpp"
+#include "lib/memory.hpp"
+#include "lib/metrics_exporter.hpp"
 #include "lib/misc.hpp"
+#include "lib/profiler.hpp"
+#include "lib/random.hpp"
+#include "lib/resource_cache.hpp"
 #include "lib/resource_loader.hpp"
+#include "lib/startup_timeline.hpp"
 #include "lib/world.hpp"
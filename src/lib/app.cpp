@@ -1,6 +1,15 @@
 #include "app.hpp"
 
+#include <string>
+
+#include "component_stats.hpp"
+#include "flight_recorder.hpp"
+#include "image_cache.hpp"
+#include "metrics_exporter.hpp"
 #include "misc.hpp"
+#include "resource_cache.hpp"
+#include "resource_loader.hpp"
+#include "startup_timeline.hpp"
 
 class NullWorld : public World {
   public:
@@ -18,9 +27,22 @@ App::App() : m_renderContext(nullptr), m_world(std::make_unique<NullWorld>()) {
 }
 
 App::~App() {
+    StartupTimeline::shutdown();
+    MetricsExporter::stop();
+    FlightRecorder::shutdown();
+    ResourceCache::mount(nullptr);
+    ImageCache::close();
 }
 
 void App::init(AppConfig config) {
+    StartupPhase phase("App::init");
+    if (config.assertZeroAllocations && !Memory::enabled()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                     "Allocation tracking is not compiled in, configure with "
+                     "-DQ14_TRACK_ALLOCATIONS=ON to assert zero allocations");
+        m_error = true;
+        return;
+    }
     SDL_WindowFlags flags = SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
     SDL_Window* window = SDL_CreateWindow(config.name, config.width, config.height, flags);
     if (!window) {
@@ -73,7 +95,42 @@ void App::init(AppConfig config) {
     m_size = {(float)bbwidth, (float)bbheight};
     m_clearColor = config.clearColor;
 
-    m_updateContext.setTicks(SDL_GetTicks());
+    m_fixedStep = config.fixedStep;
+    m_assertZeroAllocations = config.assertZeroAllocations;
+    m_textureUploadBudgetMs = config.textureUploadBudgetMs;
+    {
+        std::string path;
+        if (config.assetArchivePath) {
+            path = config.assetArchivePath;
+        } else if (auto base = SDL_GetBasePath()) {
+            path = std::string(base) + "assets.q14a";
+            SDL_free(base);
+        }
+        if (!path.empty() && m_assets.open(path.c_str())) {
+            ResourceCache::mount(&m_assets);
+        }
+    }
+    if (config.imageCache) {
+        StartupPhase cachePhase("ImageCache::open");
+        ImageCache::open(prefPath("images.q14c").c_str());
+    }
+    FlightRecorder::init(config.spikeBudgetMs);
+    if (config.metricsAddress) {
+        MetricsExporter::start(config.metricsAddress);
+    }
+    m_lastTicks = SDL_GetTicks();
+    uint64_t startTicks = m_lastTicks;
+    if (config.replayInputPath && m_inputReplayer.open(config.replayInputPath)) {
+        startTicks = m_inputReplayer.startTicks();
+        math::seed(m_inputReplayer.seed());
+        SDL_Log("Replaying input from %s, seed: %llu", config.replayInputPath,
+                static_cast<unsigned long long>(m_inputReplayer.seed()));
+    } else if (config.recordInputPath && m_inputRecorder.open(config.recordInputPath, config.seed,
+                                                              startTicks)) {
+        SDL_Log("Recording input to %s, seed: %llu", config.recordInputPath,
+                static_cast<unsigned long long>(config.seed));
+    }
+    m_updateContext.setTicks(startTicks);
     m_renderContext = {m_renderer};
 
     m_inputManager.init();
@@ -127,41 +184,111 @@ void App::event(const SDL_Event* event) {
 }
 
 void App::iterate() {
+    FlightRecorder::beginFrame();
+    Profiler::beginFrame();
+    // Closes the startup timeline once the first frame is presented
+    const bool firstFrame = StartupTimeline::recording();
+    if (firstFrame) {
+        StartupTimeline::begin("First frame");
+    }
+    auto frameStart = SDL_GetPerformanceCounter();
+    if (m_lastFrameStart > 0) {
+        // The previous frame ends where this one starts, including any wait for vsync
+        const double toMs = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        MetricsExporter::frame((frameStart - m_lastFrameStart) * toMs);
+        m_debugger.pushFrame(static_cast<float>((frameStart - m_lastFrameStart) * toMs),
+                             static_cast<float>(m_lastUpdateTicks * toMs),
+                             static_cast<float>(m_lastRenderTicks * toMs));
+    }
+    m_lastFrameStart = frameStart;
+
     // preUpdate();
     if (m_worldToChangeTo) {
         m_world = std::move(m_worldToChangeTo);
     }
+    if (ResourceLoader::uploadDecoded(m_renderContext, m_textureUploadBudgetMs) > 0) {
+        m_needsRendering = true;
+    }
 
     update();
+    auto updateEnd = SDL_GetPerformanceCounter();
     // postUpdate();
     // preRender();
     render();
     // postRender();
+    m_lastUpdateTicks = updateEnd - frameStart;
+    m_lastRenderTicks = SDL_GetPerformanceCounter() - updateEnd;
+    if (firstFrame) {
+        StartupTimeline::end();
+        StartupTimeline::finish();
+    }
+    {
+        const auto& stats = m_renderContext.lastFrameStats();
+        FlightRecorder::counter("updateMs", Profiler::toMilliseconds(m_lastUpdateTicks));
+        FlightRecorder::counter("renderMs", Profiler::toMilliseconds(m_lastRenderTicks));
+        FlightRecorder::counter("drawCalls", stats.drawCalls);
+        FlightRecorder::counter("vertices", stats.vertices);
+        FlightRecorder::counter("textureBinds", stats.textureBinds);
+        MetricsExporter::gauge("q14_update_ms", Profiler::toMilliseconds(m_lastUpdateTicks));
+        MetricsExporter::gauge("q14_render_ms", Profiler::toMilliseconds(m_lastRenderTicks));
+        MetricsExporter::gauge("q14_draw_calls", stats.drawCalls);
+        MetricsExporter::gauge("q14_vertices", stats.vertices);
+        MetricsExporter::gauge("q14_texture_binds", stats.textureBinds);
+        MetricsExporter::gauge("q14_texture_resident_bytes",
+                               static_cast<double>(ResourceCache::stats().residentBytes));
+    }
+    Profiler::endFrame();
+    ComponentStats::endFrame();
 };
 
 void App::update() {
     const double updateRate = 1.0 / 60.0;
     const uint64_t updateTicks = static_cast<uint64_t>(updateRate * 1000);
     const int maxIterations = 5;
+    Q14_PROFILE_SCOPE("App::update");
 
     m_debugger.preUpdate();
-    auto currentTicks = SDL_GetTicks();
-    auto lastTicks = m_updateContext.getTicks();
-    auto delta = currentTicks - lastTicks;
-    // TODO: fix this for real
-    int iterations = static_cast<int>(delta / updateTicks);
-
-    for (int i = std::min(iterations, maxIterations); i > 0; i--) {
-        lastTicks = lastTicks + updateTicks;
-        m_updateContext.setTicks(lastTicks);
-        m_updateContext.setInputState(m_inputManager.getState(true));
+    int iterations = 1;
+    if (!m_fixedStep) {
+        auto currentTicks = SDL_GetTicks();
+        iterations = static_cast<int>((currentTicks - m_lastTicks) / updateTicks);
+        if (iterations > maxIterations) {
+            // Drop the backlog instead of trying to catch up
+            m_lastTicks += (iterations - maxIterations) * updateTicks;
+            iterations = maxIterations;
+        }
+        m_lastTicks += iterations * updateTicks;
+    }
+
+    // NOTE: the world only sees ticks advancing in fixed steps, independent of the clock,
+    // so a recorded session replays tick for tick
+    for (int i = 0; i < iterations; i++) {
+        InputState inputState = m_inputManager.getState(true);
+        if (m_inputReplayer.active() && !m_inputReplayer.next(inputState)) {
+            SDL_Log("Replay finished after %llu ticks",
+                    static_cast<unsigned long long>(m_inputReplayer.tickCount()));
+            m_inputReplayer.close();
+            m_exit = true;
+            break;
+        }
+        m_inputRecorder.record(inputState);
+
+        m_updateContext.setTicks(m_updateContext.getTicks() + updateTicks);
+        m_updateContext.setInputState(inputState);
+        Q14_PROFILE_SCOPE("World::update");
+        auto allocations = Memory::threadAllocations();
+        auto bytes = Memory::threadAllocatedBytes();
         m_world->update(m_updateContext);
+        checkAllocations("update", allocations, bytes);
     }
 
-    m_updateContext.setTicks(lastTicks + iterations * updateTicks);
     if (m_debugger.active()) {
+        Q14_PROFILE_SCOPE("World::debug");
         m_world->debug(m_debugger);
         m_renderContext.debug(m_debugger);
+        Memory::debug(m_debugger);
+        ComponentStats::debug(m_debugger);
+        ResourceCache::debug(m_debugger);
     }
     m_debugger.postUpdate(m_updateContext);
 }
@@ -171,9 +298,15 @@ void App::render() {
         return;
     }
     m_needsRendering = false;
+    Q14_PROFILE_SCOPE("App::render");
     m_renderContext.clear(m_clearColor);
 
-    m_world->render(m_renderContext);
+    {
+        auto allocations = Memory::threadAllocations();
+        auto bytes = Memory::threadAllocatedBytes();
+        m_world->render(m_renderContext);
+        checkAllocations("render", allocations, bytes);
+    }
 
     if (m_renderContext.frameCount() % 2 == 0) {
         m_renderContext.setColor({255, 0, 0, 125});
@@ -181,13 +314,30 @@ void App::render() {
         m_renderContext.setColor(Colors::WHITE);
     }
 
-    // m_debugger.pushFrame();
-
+    // The debugger draws straight to the renderer, submit the primitives batched below it first
+    m_renderContext.flush();
     m_debugger.render();
 
     m_renderContext.present();
 }
 
+void App::checkAllocations(const char* stage, uint64_t allocations, uint64_t bytes) {
+    // Give caches, pools and vectors some frames to reach their steady state size
+    const uint64_t warmupFrames = 120;
+    if (!m_assertZeroAllocations || m_renderContext.frameCount() < warmupFrames) {
+        return;
+    }
+    allocations = Memory::threadAllocations() - allocations;
+    if (allocations > 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                     "World %s allocated %llu times (%llu bytes) in frame %llu", stage,
+                     static_cast<unsigned long long>(allocations),
+                     static_cast<unsigned long long>(Memory::threadAllocatedBytes() - bytes),
+                     static_cast<unsigned long long>(m_renderContext.frameCount()));
+        m_error = true;
+    }
+}
+
 int App::status() {
     return m_error ? -1 : (m_exit ? 1 : 0);
 }
@@ -198,6 +348,10 @@ void App::setWorld(std::unique_ptr<World> world) {
         m_world->init(m_updateContext, m_renderContext);
         m_world->resize(m_size);
     }
+    // Images decoded by the world's initial loads go to disk now instead of staying in memory
+    if (ResourceLoader::pendingCount() == 0) {
+        ImageCache::flush();
+    }
 }
 
 void App::onResizeEvent(const SDL_Event* ev) {
@@ -2,9 +2,12 @@
 
 #include <memory>
 
+#include "archive.hpp"
 #include "debugger.hpp"
 #include "gfx.hpp"
 #include "input.hpp"
+#include "input_recorder.hpp"
+#include "memory.hpp"
 #include "world.hpp"
 
 struct AppConfig {
@@ -12,6 +15,29 @@ struct AppConfig {
     int width{-1};
     int height{-1};
     Color clearColor{Colors::WHITE};
+    // Seed for math::random, stored in input recordings
+    uint64_t seed{0};
+    // Records every update tick's input to this file
+    const char* recordInputPath{nullptr};
+    // Feeds the input from this recording instead of the devices, and quits when it ends
+    const char* replayInputPath{nullptr};
+    // Runs exactly one update tick per iteration instead of following the clock
+    bool fixedStep{false};
+    // Fails with an error once a steady state world update or render allocates. Init fails
+    // without the Q14_TRACK_ALLOCATIONS build option
+    bool assertZeroAllocations{false};
+    // Asset archive read before the embedded resources, assets.q14a next to the executable when
+    // not set. Missing archives are skipped.
+    const char* assetArchivePath{nullptr};
+    // Keeps decoded images in the pref path between runs, see ImageCache
+    bool imageCache{true};
+    // Time per frame for creating textures from images decoded by ResourceLoader
+    float textureUploadBudgetMs{2.0f};
+    // Frames longer than this are dumped by the FlightRecorder, 0 only dumps on crashes
+    float spikeBudgetMs{50.0f};
+    // Serves metrics to Prometheus style scrapers, a localhost port ("9114") or a UNIX domain
+    // socket ("unix:/tmp/q14.sock"), see MetricsExporter. Not served when not set.
+    const char* metricsAddress{nullptr};
 };
 
 class App {
@@ -48,18 +74,30 @@ class App {
     void onKeyEvent(const SDL_Event* ev);
     void onMouseButtonEvent(const SDL_Event* ev);
     void onMouseMotionEvent(const SDL_Event* ev);
+    void checkAllocations(const char* stage, uint64_t allocations, uint64_t bytes);
 
     SDL_Window* m_window = nullptr;
     SDL_Renderer* m_renderer = nullptr;
     bool m_exit = false;
     bool m_error = false;
     bool m_needsRendering = true;
+    bool m_fixedStep = false;
+    bool m_assertZeroAllocations = false;
+    float m_textureUploadBudgetMs = 2.0f;
+    uint64_t m_lastTicks = 0;
+    uint64_t m_lastFrameStart = 0;
+    uint64_t m_lastUpdateTicks = 0;
+    uint64_t m_lastRenderTicks = 0;
     Size m_size;
     Color m_clearColor = Colors::BLACK;
     UpdateContext m_updateContext;
     RenderContext m_renderContext;
 
+    Archive m_assets;
+
     InputManager m_inputManager;
+    InputRecorder m_inputRecorder;
+    InputReplayer m_inputReplayer;
 
     std::unique_ptr<World> m_worldToChangeTo;
     std::unique_ptr<World> m_world;
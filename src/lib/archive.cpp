@@ -0,0 +1,150 @@
+#include "archive.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <cstring>
+
+#include "third_party/stb_image.h"
+
+namespace {
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t tocOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(Header) == 32);
+
+}  // namespace
+
+struct Archive::Entry {
+    uint64_t nameHash;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t storedSize;
+    ArchiveFormat::Compression compression;
+    uint32_t reserved;
+};
+
+uint64_t ArchiveFormat::hashName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+Archive::~Archive() {
+    close();
+}
+
+bool Archive::open(const char* path) {
+    static_assert(sizeof(Entry) == 32);
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+    const uint8_t* data = m_file.data().data();
+    const size_t size = m_file.data().size();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Archive: %s is too small", path);
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, "Q14A", 4) != 0 || header.version != ArchiveFormat::VERSION ||
+        header.fileSize != size || header.tocOffset % alignof(Entry) != 0 ||
+        header.tocOffset + uint64_t(header.entryCount) * sizeof(Entry) > size) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Archive: %s is not a valid version %u archive",
+                     path, ArchiveFormat::VERSION);
+        close();
+        return false;
+    }
+    m_entryCount = header.entryCount;
+    m_entries = reinterpret_cast<const Entry*>(data + header.tocOffset);
+    for (uint32_t i = 0; i < m_entryCount; i++) {
+        const auto& e = m_entries[i];
+        if (e.offset + e.storedSize > size ||
+            (e.compression == ArchiveFormat::Compression::None && e.storedSize != e.size) ||
+            e.compression > ArchiveFormat::Compression::Zlib ||
+            (i > 0 && m_entries[i - 1].nameHash >= e.nameHash)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Archive: %s has a broken entry %u", path,
+                         i);
+            close();
+            return false;
+        }
+    }
+    SDL_Log("Archive: %s, %u entries, %llu bytes%s", path, m_entryCount,
+            static_cast<unsigned long long>(size), m_file.mapped() ? ", mapped" : "");
+    return true;
+}
+
+void Archive::close() {
+    m_file.close();
+    m_entryCount = 0;
+    m_entries = nullptr;
+}
+
+Archive::Id Archive::find(std::string_view name) const {
+    const uint64_t hash = ArchiveFormat::hashName(name);
+    uint32_t first = 0;
+    uint32_t count = m_entryCount;
+    while (count > 0) {
+        uint32_t step = count / 2;
+        if (m_entries[first + step].nameHash < hash) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first < m_entryCount && m_entries[first].nameHash == hash ? first : INVALID_ID;
+}
+
+const Archive::Entry* Archive::entry(Id id) const {
+    return id < m_entryCount ? &m_entries[id] : nullptr;
+}
+
+uint32_t Archive::size(Id id) const {
+    auto e = entry(id);
+    return e ? e->size : 0;
+}
+
+bool Archive::compressed(Id id) const {
+    auto e = entry(id);
+    return e && e->compression != ArchiveFormat::Compression::None;
+}
+
+std::span<const uint8_t> Archive::stored(Id id) const {
+    auto e = entry(id);
+    if (!e) {
+        return {};
+    }
+    return m_file.data().subspan(e->offset, e->storedSize);
+}
+
+std::span<const uint8_t> Archive::read(Id id, std::vector<uint8_t>& buffer) const {
+    auto e = entry(id);
+    if (!e) {
+        return {};
+    }
+    if (e->compression == ArchiveFormat::Compression::None) {
+        return m_file.data().subspan(e->offset, e->size);
+    }
+    buffer.resize(e->size);
+    int written = stbi_zlib_decode_buffer(reinterpret_cast<char*>(buffer.data()),
+                                          static_cast<int>(buffer.size()),
+                                          reinterpret_cast<const char*>(&m_file.data()[e->offset]),
+                                          static_cast<int>(e->storedSize));
+    if (written != static_cast<int>(e->size)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Archive: failed to inflate entry %u", id);
+        return {};
+    }
+    return buffer;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+// Read-only packed asset archive (.q14a), written by tools/pack_assets.py.
+//
+// All integers are little endian. The file starts with a 32 byte header:
+//   char magic[4] "Q14A", uint32 version, uint32 entryCount, uint32 reserved,
+//   uint64 tocOffset, uint64 fileSize
+// The table of contents is entryCount 32 byte entries sorted by name hash:
+//   uint64 nameHash, uint64 offset, uint32 size, uint32 storedSize, uint32 compression,
+//   uint32 reserved
+// Names are paths relative to the packed directory, e.g. "Images/Tiles/Tile_0001.png", hashed
+// with 64 bit FNV-1a. Blobs start on 16 byte boundaries, entries with identical contents share
+// one blob. Compressed entries are zlib streams of storedSize bytes inflating to size bytes.
+//
+// The file is memory mapped where possible, so entries cost nothing until they are read.
+namespace ArchiveFormat {
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ALIGNMENT = 16;
+
+enum class Compression : uint32_t { None = 0, Zlib = 1 };
+
+uint64_t hashName(std::string_view name);
+}  // namespace ArchiveFormat
+
+class Archive {
+  public:
+    using Id = uint32_t;
+    static constexpr Id INVALID_ID = UINT32_MAX;
+
+    Archive() = default;
+    ~Archive();
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const {
+        return m_file.isOpen();
+    }
+
+    uint32_t entryCount() const {
+        return m_entryCount;
+    }
+
+    // INVALID_ID when the archive has no entry with this name
+    Id find(std::string_view name) const;
+
+    // Size of the entry's contents
+    uint32_t size(Id id) const;
+    bool compressed(Id id) const;
+    // The entry as stored, points into the mapped file
+    std::span<const uint8_t> stored(Id id) const;
+    // The entry's contents: uncompressed entries without a copy, compressed ones are inflated
+    // into buffer. Empty on error. Safe to call from several threads.
+    std::span<const uint8_t> read(Id id, std::vector<uint8_t>& buffer) const;
+
+  private:
+    struct Entry;
+    const Entry* entry(Id id) const;
+
+    MappedFile m_file;
+    uint32_t m_entryCount = 0;
+    const Entry* m_entries = nullptr;
+};
@@ -1,10 +1,64 @@
 #include "box2d_debug.hpp"
 
+#include <array>
+#include <cmath>
+
 namespace {
 
+constexpr int MAX_POLYGON_VERTICES = 8;
+constexpr int CIRCLE_SEGMENTS = 16;
+constexpr int CAPSULE_SEGMENTS = CIRCLE_SEGMENTS / 2;
+constexpr uint8_t FILL_ALPHA = 125;
+constexpr float PI = 3.14159265358979f;
+
+const std::array<Vec2, CIRCLE_SEGMENTS>& unitCircle() {
+    static const auto points = [] {
+        std::array<Vec2, CIRCLE_SEGMENTS> points;
+        for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+            float angle = 2.0f * PI * i / CIRCLE_SEGMENTS;
+            points[i] = {std::cos(angle), std::sin(angle)};
+        }
+        return points;
+    }();
+    return points;
+}
+
+Box2dDebugDraw* debugDraw(void* context) {
+    return static_cast<Box2dDebugDraw*>(context);
+}
+
+Vec2 toVec2(b2Vec2 v) {
+    return {v.x, v.y};
+}
+
+Color fillColor(b2HexColor color) {
+    Color c = Color::fromIntRGB(color);
+    c.a = FILL_ALPHA;
+    return c;
+}
+
+// Outline of a capsule, two half circles joined at the sides
+std::array<Vec2, 2 * (CAPSULE_SEGMENTS + 1)> capsule(Vec2 p1, Vec2 p2, float radius) {
+    std::array<Vec2, 2 * (CAPSULE_SEGMENTS + 1)> points;
+    auto axis = p2 - p1;
+    float base = std::atan2(axis.y, axis.x) - PI / 2.0f;
+    for (int i = 0; i <= CAPSULE_SEGMENTS; i++) {
+        float angle = base + PI * i / CAPSULE_SEGMENTS;
+        Vec2 offset = Vec2(std::cos(angle), std::sin(angle)) * radius;
+        points[i] = p2 + offset;
+        points[CAPSULE_SEGMENTS + 1 + i] = p1 - offset;
+    }
+    return points;
+}
+
 void DrawPolygonFcn(const b2Vec2* vertices, int vertexCount, b2HexColor color, void* context) {
-    // SDL_Log("%s, vertexCount: %d", __FUNCTION__, vertexCount);
-    // static_cast<RenderContext*>(context)->DrawPolygon(vertices, vertexCount, color);
+    SDL_assert(vertexCount <= MAX_POLYGON_VERTICES);
+    std::array<Vec2, MAX_POLYGON_VERTICES> points;
+    for (int i = 0; i < vertexCount; i++) {
+        points[i] = toVec2(vertices[i]);
+    }
+    debugDraw(context)->stroke({points.data(), static_cast<size_t>(vertexCount)},
+                               Color::fromIntRGB(color));
 }
 
 void DrawSolidPolygonFcn(b2Transform transform,
@@ -13,63 +67,85 @@ void DrawSolidPolygonFcn(b2Transform transform,
                          float radius,
                          b2HexColor color,
                          void* context) {
-    // SDL_Log("%s, vertexCount: %d, radius: %f", __FUNCTION__, vertexCount, radius);
-
-    Color c = Color::fromIntRGB(color);
-    c.a = 125;
-    static_cast<RenderContext*>(context)->drawPolygon(4, true, [&](Vertex& vertex, int index) {
-        auto p = b2TransformPoint(transform, vertices[index]);
-        vertex.position.x = p.x;
-        vertex.position.y = p.y;
-        vertex.color = c;
-    });
+    // NOTE: rounded polygons are drawn without their radius
+    SDL_assert(vertexCount <= MAX_POLYGON_VERTICES);
+    std::array<Vec2, MAX_POLYGON_VERTICES> points;
+    for (int i = 0; i < vertexCount; i++) {
+        points[i] = toVec2(b2TransformPoint(transform, vertices[i]));
+    }
+    std::span<const Vec2> polygon = {points.data(), static_cast<size_t>(vertexCount)};
+    debugDraw(context)->fill(polygon, fillColor(color));
+    debugDraw(context)->stroke(polygon, Color::fromIntRGB(color));
 }
 
 void DrawCircleFcn(b2Vec2 center, float radius, b2HexColor color, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawCircle(center, radius, color);
+    std::array<Vec2, CIRCLE_SEGMENTS> points;
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+        points[i] = toVec2(center) + unitCircle()[i] * radius;
+    }
+    debugDraw(context)->stroke(points, Color::fromIntRGB(color));
 }
 
 void DrawSolidCircleFcn(b2Transform transform, float radius, b2HexColor color, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawSolidCircle(transform, b2Vec2_zero, radius, color);
+    Vec2 center = toVec2(transform.p);
+    std::array<Vec2, CIRCLE_SEGMENTS> points;
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+        points[i] = center + unitCircle()[i] * radius;
+    }
+    auto draw = debugDraw(context);
+    draw->fill(points, fillColor(color));
+    draw->stroke(points, Color::fromIntRGB(color));
+    // Shows the rotation
+    draw->line(center, center + Vec2(transform.q.c, transform.q.s) * radius,
+               Color::fromIntRGB(color));
 }
 
 void DrawCapsuleFcn(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColor color, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawCapsule(p1, p2, radius, color);
+    auto points = capsule(toVec2(p1), toVec2(p2), radius);
+    debugDraw(context)->stroke(points, Color::fromIntRGB(color));
 }
 
 void DrawSolidCapsuleFcn(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColor color, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawSolidCapsule(p1, p2, radius, color);
+    auto points = capsule(toVec2(p1), toVec2(p2), radius);
+    debugDraw(context)->fill(points, fillColor(color));
+    debugDraw(context)->stroke(points, Color::fromIntRGB(color));
 }
 
 void DrawSegmentFcn(b2Vec2 p1, b2Vec2 p2, b2HexColor color, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawSegment(p1, p2, color);
+    debugDraw(context)->line(toVec2(p1), toVec2(p2), Color::fromIntRGB(color));
 }
 
 void DrawTransformFcn(b2Transform transform, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawTransform(transform);
+    const float axisScale = 0.4f;
+    Vec2 p = toVec2(transform.p);
+    Vec2 xAxis = Vec2(transform.q.c, transform.q.s) * axisScale;
+    Vec2 yAxis = Vec2(-transform.q.s, transform.q.c) * axisScale;
+    debugDraw(context)->line(p, p + xAxis, Colors::RED);
+    debugDraw(context)->line(p, p + yAxis, Colors::GREEN);
 }
 
 void DrawPointFcn(b2Vec2 p, float size, b2HexColor color, void* context) {
-    // SDL_Log("%s", __FUNCTION__);
-    auto renderer = static_cast<RenderContext*>(context);
-    renderer->setColor(Color::fromIntRGB(color));
-    renderer->drawPoint({p.x, p.y}, size);
+    debugDraw(context)->point(toVec2(p), size, Color::fromIntRGB(color));
 }
 
 void DrawStringFcn(b2Vec2 p, const char* s, void* context) {
-    SDL_Log("%s", __FUNCTION__);
-    // static_cast<RenderContext*>(context)->DrawString(p, s);
+    // RenderContext has no text rendering
 }
 
 }  // namespace
 
 void Box2dDebugDraw::render(b2WorldId worldId, RenderContext& context) {
+    m_fillVertices.clear();
+    m_fillIndices.clear();
+    m_lineVertices.clear();
+    m_lineIndices.clear();
+
+    // Lines are tessellated in world units, so keep them about one pixel wide at the current scale
+    const auto& matrix = context.getTransform();
+    float scale = glm::length(Vec2(matrix[0][0], matrix[0][1]));
+    m_pixelSize = scale > 0.0f ? 1.0f / scale : 1.0f;
+
+    auto view = context.viewBounds();
     b2DebugDraw draw{DrawPolygonFcn,
                      DrawSolidPolygonFcn,
                      DrawCircleFcn,
@@ -80,8 +156,8 @@ void Box2dDebugDraw::render(b2WorldId worldId, RenderContext& context) {
                      DrawTransformFcn,
                      DrawPointFcn,
                      DrawStringFcn,
-                     {},
-                     false,  // drawUsingBounds
+                     {{view.left(), view.top()}, {view.right(), view.bottom()}},
+                     true,   // drawUsingBounds
                      true,   // shapes
                      true,   // joints
                      false,  // joint extras
@@ -92,9 +168,63 @@ void Box2dDebugDraw::render(b2WorldId worldId, RenderContext& context) {
                      false,  // normals
                      false,  // impulse
                      false,  // friction
-                     static_cast<void*>(&context)};
+                     static_cast<void*>(this)};
 
-    context.setColor(Colors::WHITE);
-    context.setTexture(nullptr);
     b2World_Draw(worldId, &draw);
+
+    context.drawGeometry(m_fillVertices, m_fillIndices);
+    context.drawGeometry(m_lineVertices, m_lineIndices);
+}
+
+void Box2dDebugDraw::fill(std::span<const Vec2> points, Color color) {
+    if (points.size() < 3) {
+        return;
+    }
+    // Triangle fan, the Box2D primitives are convex
+    int base = static_cast<int>(m_fillVertices.size());
+    for (const auto& p : points) {
+        m_fillVertices.push_back({p, color});
+    }
+    for (int i = 1; i + 1 < static_cast<int>(points.size()); i++) {
+        m_fillIndices.insert(m_fillIndices.end(), {base, base + i, base + i + 1});
+    }
+}
+
+void Box2dDebugDraw::stroke(std::span<const Vec2> points, Color color, bool closed) {
+    const size_t count = points.size();
+    if (count < 2) {
+        return;
+    }
+    for (size_t i = 0; i + 1 < count; i++) {
+        line(points[i], points[i + 1], color);
+    }
+    if (closed && count > 2) {
+        line(points[count - 1], points[0], color);
+    }
+}
+
+void Box2dDebugDraw::line(Vec2 p0, Vec2 p1, Color color) {
+    Vec2 direction = p1 - p0;
+    float length = glm::length(direction);
+    direction = length > 0.0f ? direction / length : Vec2(1.0f, 0.0f);
+    Vec2 normal = Vec2(-direction.y, direction.x) * (m_pixelSize * 0.5f);
+
+    int base = static_cast<int>(m_lineVertices.size());
+    m_lineVertices.push_back({p0 + normal, color});
+    m_lineVertices.push_back({p0 - normal, color});
+    m_lineVertices.push_back({p1 + normal, color});
+    m_lineVertices.push_back({p1 - normal, color});
+    m_lineIndices.insert(m_lineIndices.end(),
+                         {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+}
+
+void Box2dDebugDraw::point(Vec2 p, float size, Color color) {
+    float half = size * m_pixelSize * 0.5f;
+    int base = static_cast<int>(m_lineVertices.size());
+    m_lineVertices.push_back({{p.x - half, p.y - half}, color});
+    m_lineVertices.push_back({{p.x + half, p.y - half}, color});
+    m_lineVertices.push_back({{p.x - half, p.y + half}, color});
+    m_lineVertices.push_back({{p.x + half, p.y + half}, color});
+    m_lineIndices.insert(m_lineIndices.end(),
+                         {base, base + 1, base + 2, base + 2, base + 1, base + 3});
 }
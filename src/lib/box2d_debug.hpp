@@ -2,9 +2,32 @@
 
 #include <box2d/box2d.h>
 
+#include <span>
+#include <vector>
+
 #include "gfx.hpp"
 
+// Draws a Box2D world by tessellating every primitive into two vertex buffers, one for fills and
+// one for lines, which go into the RenderContext batch. The buffers keep their capacity between
+// frames, so a steady state frame does not allocate.
 class Box2dDebugDraw {
   public:
     void render(b2WorldId worldId, RenderContext& context);
+
+    // Used by the Box2D callbacks, points are in world coordinates
+    void fill(std::span<const Vec2> points, Color color);
+    void stroke(std::span<const Vec2> points, Color color, bool closed = true);
+    void line(Vec2 p0, Vec2 p1, Color color);
+    void point(Vec2 p, float size, Color color);
+
+    float pixelSize() const {
+        return m_pixelSize;
+    }
+
+  private:
+    std::vector<Vertex> m_fillVertices;
+    std::vector<int> m_fillIndices;
+    std::vector<Vertex> m_lineVertices;
+    std::vector<int> m_lineIndices;
+    float m_pixelSize = 1.0f;
 };
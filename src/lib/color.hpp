@@ -25,6 +25,8 @@ struct Color {
         c.a = 255;
         return c;
     }
+
+    bool operator==(const Color& other) const = default;
 };
 
 namespace Colors {
@@ -0,0 +1,129 @@
+#include "component_stats.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "debugger.hpp"
+#include "misc.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+using ComponentStats::Phase;
+using ComponentStats::TypeStats;
+
+// Types seen so far, zeroed at the end of each frame so lookups stay cheap
+std::vector<TypeStats> s_current;
+std::vector<TypeStats> s_last;
+// Components of one type tend to be called in a row
+size_t s_lastHit = 0;
+std::vector<TypeStats> s_sorted;
+
+double sortKey(const TypeStats& stats, int column) {
+    const auto& phase = stats[column <= 3 ? Phase::Update : Phase::Render];
+    switch ((column - 1) % 3) {
+        case 0:
+            return phase.calls;
+        case 1:
+            return static_cast<double>(phase.ticks);
+        default:
+            return static_cast<double>(phase.maxTicks);
+    }
+}
+
+}  // namespace
+
+bool ComponentStats::enabled() {
+#ifdef Q14_COMPONENT_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ComponentStats::endFrame() {
+    s_last.clear();
+    for (auto& stats : s_current) {
+        if (stats[Phase::Update].calls > 0 || stats[Phase::Render].calls > 0) {
+            s_last.push_back(stats);
+        }
+        for (auto& phase : stats.phases) {
+            phase = {};
+        }
+    }
+}
+
+std::span<const TypeStats> ComponentStats::lastFrame() {
+    return s_last;
+}
+
+uint64_t ComponentStats::begin() {
+    return SDL_GetPerformanceCounter();
+}
+
+void ComponentStats::end(const std::type_info& type, Phase phase, uint64_t start) {
+    const uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    if (s_lastHit >= s_current.size() || *s_current[s_lastHit].type != type) {
+        auto it = std::find_if(s_current.begin(), s_current.end(),
+                               [&type](const TypeStats& stats) { return *stats.type == type; });
+        if (it == s_current.end()) {
+            s_current.push_back({&type, typeName(type), {}});
+            it = s_current.end() - 1;
+        }
+        s_lastHit = it - s_current.begin();
+    }
+    auto& stats = s_current[s_lastHit].phases[static_cast<int>(phase)];
+    stats.calls++;
+    stats.ticks += ticks;
+    stats.maxTicks = std::max(stats.maxTicks, ticks);
+}
+
+void ComponentStats::debug(Debugger& debugger) {
+    if (!debugger.pushSection("COMPONENTS")) {
+        return;
+    }
+    if (!enabled()) {
+        debugger.label("stats", "off, configure with -DQ14_COMPONENT_STATS=ON");
+        debugger.popSection();
+        return;
+    }
+
+    static constexpr const char* COLUMNS[] = {"type",    "updates",   "update ms", "max us",
+                                              "renders", "render ms", "max us"};
+    const int column = debugger.tableHeader("components", COLUMNS, 2);
+    s_sorted.assign(s_last.begin(), s_last.end());
+    if (column == 0) {
+        std::sort(s_sorted.begin(), s_sorted.end(), [](const TypeStats& a, const TypeStats& b) {
+            return std::strcmp(a.name, b.name) < 0;
+        });
+    } else {
+        std::sort(s_sorted.begin(), s_sorted.end(),
+                  [column](const TypeStats& a, const TypeStats& b) {
+                      return sortKey(a, column) > sortKey(b, column);
+                  });
+    }
+
+    char cells[std::size(COLUMNS)][32];
+    const char* row[std::size(COLUMNS)];
+    for (const auto& stats : s_sorted) {
+        std::snprintf(cells[0], sizeof(cells[0]), "%s", stats.name);
+        for (auto phase : {Phase::Update, Phase::Render}) {
+            const int first = phase == Phase::Update ? 1 : 4;
+            const auto& phaseStats = stats[phase];
+            std::snprintf(cells[first], sizeof(cells[first]), "%u", phaseStats.calls);
+            std::snprintf(cells[first + 1], sizeof(cells[first + 1]), "%.3f",
+                          Profiler::toMilliseconds(phaseStats.ticks));
+            std::snprintf(cells[first + 2], sizeof(cells[first + 2]), "%.1f",
+                          Profiler::toMilliseconds(phaseStats.maxTicks) * 1000.0);
+        }
+        for (size_t i = 0; i < std::size(COLUMNS); i++) {
+            row[i] = cells[i];
+        }
+        debugger.tableRow(row);
+    }
+    debugger.popSection();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <typeinfo>
+
+class Debugger;
+
+// Call counts and times of component update and render calls, per concrete component type and
+// frame.
+//
+//   for (auto& component : m_components) {
+//       Q14_COMPONENT_SCOPE(typeid(*component), Update);
+//       component->update(context, updateContext);
+//   }
+//
+// Only compiled in with the Q14_COMPONENT_STATS option, the macro and its typeid argument vanish
+// otherwise. Main thread only.
+namespace ComponentStats {
+
+enum class Phase : uint8_t { Update, Render, Count };
+
+struct PhaseStats {
+    uint32_t calls;
+    uint64_t ticks;
+    uint64_t maxTicks;
+};
+
+struct TypeStats {
+    const std::type_info* type;
+    const char* name;
+    PhaseStats phases[static_cast<int>(Phase::Count)];
+
+    const PhaseStats& operator[](Phase phase) const {
+        return phases[static_cast<int>(phase)];
+    }
+};
+
+// False when the scopes are not compiled in, there are no stats then
+bool enabled();
+
+// Closes the current frame, called by App once per frame and by benchmarks per iteration
+void endFrame();
+// Types with calls in the last completed frame, in order of their first call
+std::span<const TypeStats> lastFrame();
+
+// COMPONENTS section: the last frame as a table sortable by any column
+void debug(Debugger& debugger);
+
+// Used by ComponentScope
+uint64_t begin();
+void end(const std::type_info& type, Phase phase, uint64_t start);
+
+}  // namespace ComponentStats
+
+class ComponentScope {
+  public:
+    ComponentScope(const std::type_info& type, ComponentStats::Phase phase)
+        : m_type(type), m_phase(phase), m_start(ComponentStats::begin()){};
+    ~ComponentScope() {
+        ComponentStats::end(m_type, m_phase, m_start);
+    }
+    ComponentScope(const ComponentScope&) = delete;
+    ComponentScope& operator=(const ComponentScope&) = delete;
+
+  private:
+    const std::type_info& m_type;
+    ComponentStats::Phase m_phase;
+    uint64_t m_start;
+};
+
+#define Q14_COMPONENT_CONCAT_IMPL(a, b) a##b
+#define Q14_COMPONENT_CONCAT(a, b) Q14_COMPONENT_CONCAT_IMPL(a, b)
+
+#ifdef Q14_COMPONENT_STATS
+#define Q14_COMPONENT_SCOPE(type, phase)                           \
+    ComponentScope Q14_COMPONENT_CONCAT(componentScope, __LINE__)( \
+        type, ComponentStats::Phase::phase)
+#else
+#define Q14_COMPONENT_SCOPE(type, phase) \
+    do {                                 \
+    } while (0)
+#endif
@@ -34,8 +34,8 @@ class UpdateContext {
 
   protected:
   private:
-    uint64_t m_ticks;
-    uint64_t m_ticksDelta;
+    uint64_t m_ticks = 0;
+    uint64_t m_ticksDelta = 0;
 
     InputState m_inputState;
 };
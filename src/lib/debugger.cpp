@@ -1,6 +1,17 @@
 
 #include "debugger.hpp"
 
+#include "gfx.hpp"
+#include "mapped_file.hpp"
+#include "memory.hpp"
+#include "misc.hpp"
+#include "startup_timeline.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
 namespace {
 
 constexpr const char* WINDOW_NAME = "DEBUG";
@@ -24,6 +35,8 @@ constexpr int ROW_HEIGHT = 15;
 #define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
 #define NK_INCLUDE_FONT_BAKING
 #define NK_INCLUDE_DEFAULT_FONT
+// Lets nk_sdl_render compare command buffers with memcmp to skip unchanged frames
+#define NK_ZERO_COMMAND_MEMORY
 
 #define NK_IMPLEMENTATION
 #include "third_party/nuklear.h"
@@ -38,6 +51,155 @@ constexpr int ROW_HEIGHT = 15;
 #pragma GCC diagnostic pop
 #endif
 
+namespace {
+
+// Baked default font, cached per pixel height in the pref path. Baking decompresses the TTF and
+// rasterizes every glyph, loading the cache is one texture upload. Bump FONT_ATLAS_VERSION when
+// the font config passed to the baker changes.
+constexpr uint32_t FONT_ATLAS_VERSION = 1;
+
+struct FontAtlasHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t glyphSize;
+    // Of the embedded TTF, so a nuklear update invalidates the cache
+    uint64_t fontHash;
+    float pixelHeight;
+    int32_t width;
+    int32_t height;
+    int32_t glyphCount;
+    float fontHeight;
+    float ascent;
+    float descent;
+    struct nk_recti custom;
+    struct nk_cursor cursors[NK_CURSOR_COUNT];
+};
+// Followed by glyphCount nk_font_glyph and width * height RGBA pixels
+
+uint64_t defaultFontHash() {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : nk_proggy_clean_ttf_compressed_data_base85) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string fontAtlasPath(float pixelHeight) {
+    char name[64];
+    SDL_snprintf(name, sizeof(name), "debug_font_%d.q14f", static_cast<int>(pixelHeight * 100));
+    return prefPath(name);
+}
+
+void saveFontAtlas(float pixelHeight, const nk_font_atlas& atlas, const nk_font& font,
+                   const void* pixels, int width, int height) {
+    FontAtlasHeader header{};
+    std::memcpy(header.magic, "Q14F", 4);
+    header.version = FONT_ATLAS_VERSION;
+    header.headerSize = sizeof(FontAtlasHeader);
+    header.glyphSize = sizeof(nk_font_glyph);
+    header.fontHash = defaultFontHash();
+    header.pixelHeight = pixelHeight;
+    header.width = width;
+    header.height = height;
+    header.glyphCount = atlas.glyph_count;
+    header.fontHeight = font.info.height;
+    header.ascent = font.info.ascent;
+    header.descent = font.info.descent;
+    header.custom = atlas.custom;
+    std::memcpy(header.cursors, atlas.cursors, sizeof(header.cursors));
+
+    auto path = fontAtlasPath(pixelHeight);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    const size_t pixelBytes = static_cast<size_t>(width) * height * 4;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(atlas.glyphs, sizeof(nk_font_glyph), atlas.glyph_count, file) ==
+                  static_cast<size_t>(atlas.glyph_count) &&
+              std::fwrite(pixels, 1, pixelBytes, file) == pixelBytes;
+    if (std::fclose(file) != 0 || !ok) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Debugger: failed to write %s", path.c_str());
+        std::remove(path.c_str());
+    }
+}
+
+// Sets up the nuklear atlas like nk_font_atlas_bake and nk_font_atlas_end would, from the cache
+nk_font* loadFontAtlas(float pixelHeight) {
+    MappedFile file;
+    if (!file.open(fontAtlasPath(pixelHeight).c_str())) {
+        return nullptr;
+    }
+    auto data = file.data();
+    FontAtlasHeader header;
+    if (data.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    const size_t glyphBytes = static_cast<size_t>(header.glyphCount) * sizeof(nk_font_glyph);
+    const size_t pixelBytes = static_cast<size_t>(header.width) * header.height * 4;
+    if (std::memcmp(header.magic, "Q14F", 4) != 0 || header.version != FONT_ATLAS_VERSION ||
+        header.headerSize != sizeof(header) || header.glyphSize != sizeof(nk_font_glyph) ||
+        header.fontHash != defaultFontHash() || header.pixelHeight != pixelHeight ||
+        header.glyphCount <= 0 || header.width <= 0 || header.height <= 0 ||
+        data.size() != sizeof(header) + glyphBytes + pixelBytes) {
+        return nullptr;
+    }
+
+    auto atlas = &sdl.atlas;
+    nk_font_atlas_init_default(atlas);
+    auto alloc = [atlas](size_t size) {
+        return atlas->permanent.alloc(atlas->permanent.userdata, nullptr, size);
+    };
+    auto config = static_cast<struct nk_font_config*>(alloc(sizeof(struct nk_font_config)));
+    auto font = static_cast<nk_font*>(alloc(sizeof(nk_font)));
+    atlas->glyphs = static_cast<nk_font_glyph*>(alloc(glyphBytes));
+    *config = nk_font_config(pixelHeight);
+    config->n = config;
+    config->p = config;
+    config->font = &font->info;
+    nk_zero(font, sizeof(*font));
+    font->config = config;
+    atlas->config = config;
+    atlas->fonts = font;
+    atlas->default_font = font;
+    atlas->font_num = 1;
+    atlas->glyph_count = header.glyphCount;
+    std::memcpy(atlas->glyphs, &data[sizeof(header)], glyphBytes);
+    atlas->tex_width = header.width;
+    atlas->tex_height = header.height;
+    atlas->custom = header.custom;
+    std::memcpy(atlas->cursors, header.cursors, sizeof(atlas->cursors));
+
+    nk_baked_font baked = {header.fontHeight, header.ascent, header.descent,
+                           0,                 static_cast<nk_rune>(header.glyphCount),
+                           config->range};
+    nk_font_init(font, pixelHeight, config->fallback_glyph, atlas->glyphs, &baked,
+                 nk_handle_ptr(nullptr));
+    nk_sdl_device_upload_atlas(&data[sizeof(header) + glyphBytes], header.width, header.height);
+    nk_font_atlas_end(atlas, nk_handle_ptr(sdl.ogl.font_tex), &sdl.ogl.tex_null);
+    return font;
+}
+
+nk_font* bakeFontAtlas(float pixelHeight) {
+    struct nk_font_atlas* atlas;
+    struct nk_font_config config = nk_font_config(0);
+    nk_sdl_font_stash_begin(&atlas);
+    auto font = nk_font_atlas_add_default(atlas, pixelHeight, &config);
+    int width, height;
+    auto pixels = nk_font_atlas_bake(atlas, &width, &height, NK_FONT_ATLAS_RGBA32);
+    if (pixels) {
+        saveFontAtlas(pixelHeight, *atlas, *font, pixels, width, height);
+        nk_sdl_device_upload_atlas(pixels, width, height);
+    }
+    nk_font_atlas_end(atlas, nk_handle_ptr(sdl.ogl.font_tex), &sdl.ogl.tex_null);
+    return font;
+}
+
+}  // namespace
+
 extern "C" {
 nk_bool nkx_button_text(struct nk_context* ctx, const char* title, bool enabled) {
     if (!ctx)
@@ -66,23 +228,46 @@ nk_bool nkx_button_symbol(struct nk_context* ctx, enum nk_symbol_type symbol, bo
 }
 }
 
+Debugger::~Debugger() {
+    // Before the renderer, which App's owner destroys after the App
+    if (m_thumbnailAtlas) {
+        SDL_DestroyTexture(m_thumbnailAtlas);
+    }
+}
+
 void Debugger::init(SDL_Window* window, SDL_Renderer* renderer) {
+    StartupPhase phase("Debugger::init");
     float scale = SDL_GetWindowDisplayScale(window);
     float font_scale = scale;
 
     // TODO: fix nk_sdl_* to not use a global context
     nk_context* ctx = nk_sdl_init(window, renderer, scale);
     m_ctx = {ctx, nk_free};
+    m_renderer = renderer;
+    // Thumbnails are drawn into it premultiplied, like the UI in nk_sdl_render
+    m_thumbnailAtlas =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                          THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE);
+    if (m_thumbnailAtlas &&
+        SDL_SetTextureBlendMode(m_thumbnailAtlas, premultipliedBlendMode()) != 0) {
+        SDL_DestroyTexture(m_thumbnailAtlas);
+        m_thumbnailAtlas = nullptr;
+    }
+    if (!m_thumbnailAtlas) {
+        SDL_Log("Debugger: no thumbnail atlas (%s), lists show textures directly", SDL_GetError());
+    }
     // Font
     {
-        struct nk_font_atlas* atlas;
-        struct nk_font_config config = nk_font_config(0);
-        struct nk_font* font;
-
-        nk_sdl_font_stash_begin(&atlas);
-        font = nk_font_atlas_add_default(atlas, 13 * font_scale, &config);
-
-        nk_sdl_font_stash_end();
+        const float pixelHeight = 13 * font_scale;
+        const uint64_t start = SDL_GetPerformanceCounter();
+        struct nk_font* font = loadFontAtlas(pixelHeight);
+        const bool cached = font != nullptr;
+        if (!font) {
+            font = bakeFontAtlas(pixelHeight);
+        }
+        SDL_Log("Debugger: font atlas %s in %.2f ms", cached ? "loaded" : "baked",
+                static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 /
+                    static_cast<double>(SDL_GetPerformanceFrequency()));
 
         font->handle.height /= font_scale;
         // nk_style_load_all_cursors(ctx, atlas->cursors);
@@ -139,6 +324,11 @@ void Debugger::event(const SDL_Event* event) {
         } else {
             m_windowSize = {w, glm::min(s, h)};
         }
+    } else if (event->type == SDL_EVENT_RENDER_TARGETS_RESET ||
+               event->type == SDL_EVENT_RENDER_DEVICE_RESET) {
+        // The atlas lost its content, the thumbnails in view are drawn again
+        m_thumbnails = {};
+        m_thumbnailQueue.clear();
     }
 
     nk_sdl_handle_event(event);
@@ -147,6 +337,7 @@ void Debugger::event(const SDL_Event* event) {
 void Debugger::preUpdate() {
     auto ctx = m_ctx.get();
     nk_input_end(ctx);
+    m_uiFrame++;
 
     if (m_toggleWindow) {
         m_toggleWindow = false;
@@ -159,6 +350,7 @@ void Debugger::preUpdate() {
 }
 
 void Debugger::postUpdate(const UpdateContext& context) {
+    Q14_MEMORY_SCOPE(Debugger);
     auto ctx = m_ctx.get();
 
     if (m_windowShown) {
@@ -188,14 +380,19 @@ void Debugger::postUpdate(const UpdateContext& context) {
             }
             nk_tree_pop(ctx);
         }
+        frames();
+        profiler();
         if (nk_tree_push(ctx, NK_TREE_TAB, "LOG", NK_MAXIMIZED)) {
+            std::lock_guard lock(m_logMutex);
+            const auto count = static_cast<int>(glm::min<uint64_t>(m_logCount, LOG_LINES));
+            const auto first = m_logCount - count;
             struct nk_list_view view;
             nk_layout_row_dynamic(ctx, ROW_HEIGHT * 10 * 1.2, 1);
-            if (nk_list_view_begin(ctx, &view, "test", NK_WINDOW_BORDER, ROW_HEIGHT,
-                                   static_cast<int>(m_logs.size()))) {
+            if (nk_list_view_begin(ctx, &view, "test", NK_WINDOW_BORDER, ROW_HEIGHT, count)) {
                 nk_layout_row_dynamic(ctx, ROW_HEIGHT, 1);
                 for (int i = 0; i < view.count; ++i) {
-                    nk_label(ctx, m_logs.at(view.begin + i).data(), NK_TEXT_LEFT);
+                    nk_label(ctx, m_logs[(first + view.begin + i) % LOG_LINES].data(),
+                             NK_TEXT_LEFT);
                 }
                 nk_list_view_end(&view);
             }
@@ -219,14 +416,197 @@ void Debugger::postUpdate(const UpdateContext& context) {
 }
 
 void Debugger::render() {
+    Q14_PROFILE_SCOPE("Debugger::render");
+    Q14_MEMORY_SCOPE(Debugger);
+    drawThumbnails();
     nk_sdl_render(NK_ANTI_ALIASING_ON);
 }
 
-void Debugger::log(const char* log) {
-    if (m_logs.size() >= 10) {
-        m_logs.erase(m_logs.begin());
+void Debugger::pushFrame(float frameMs, float updateMs, float renderMs) {
+    m_frames[m_frameCount % FRAME_HISTORY] = {frameMs, updateMs, renderMs};
+    m_frameCount++;
+}
+
+void Debugger::frames() {
+    auto ctx = m_ctx.get();
+    if (!nk_tree_push(ctx, NK_TREE_TAB, "FRAME", NK_MAXIMIZED)) {
+        return;
+    }
+
+    // Refreshed a few times a second instead of every frame, so the overlay's commands stay the
+    // same in between and nk_sdl_render reuses its cached target
+    const uint64_t now = SDL_GetTicks();
+    if (now >= m_frameStatsRefresh) {
+        m_frameStatsRefresh = now + FRAME_STATS_INTERVAL_MS;
+        updateFrameStats();
+    }
+    const auto& stats = m_frameStats;
+
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT, 5);
+    nk_spacer(ctx);
+    nk_label(ctx, "p50", NK_TEXT_RIGHT);
+    nk_label(ctx, "p95", NK_TEXT_RIGHT);
+    nk_label(ctx, "p99", NK_TEXT_RIGHT);
+    nk_label(ctx, "max", NK_TEXT_RIGHT);
+    const char* names[] = {"frame", "update", "render"};
+    for (int row = 0; row < 3; row++) {
+        nk_layout_row_dynamic(ctx, ROW_HEIGHT, 5);
+        nk_label(ctx, names[row], NK_TEXT_LEFT);
+        for (float value : stats.percentiles[row]) {
+            nk_labelf(ctx, NK_TEXT_RIGHT, "%.2f", value);
+        }
+    }
+
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT, 1);
+    nk_labelf(ctx, NK_TEXT_LEFT, "%d of %d frames over %.1f ms", stats.overBudget, stats.count,
+              m_frameBudget);
+    nk_labelf(ctx, NK_TEXT_LEFT, "overlay reused on %d%% of frames", stats.overlayReuse);
+
+    // The most recent frames, with the budget as a flat line
+    const int shown = static_cast<int>(m_frameChart.size());
+    const float max = stats.chartMax;
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT * 6, 1);
+    if (shown > 0 && nk_chart_begin(ctx, NK_CHART_LINES, shown, 0.0f, max)) {
+        const auto highlight = nk_rgba(255, 255, 255, 255);
+        nk_chart_add_slot_colored(ctx, NK_CHART_LINES, nk_rgba(70, 150, 220, 255), highlight, shown,
+                                  0.0f, max);
+        nk_chart_add_slot_colored(ctx, NK_CHART_LINES, nk_rgba(90, 190, 90, 255), highlight, shown,
+                                  0.0f, max);
+        nk_chart_add_slot_colored(ctx, NK_CHART_LINES, nk_rgba(120, 120, 120, 255), highlight,
+                                  shown, 0.0f, max);
+        for (const auto& frame : m_frameChart) {
+            nk_chart_push_slot(ctx, frame.frame, 0);
+            nk_chart_push_slot(ctx, frame.update, 1);
+            nk_chart_push_slot(ctx, frame.render, 2);
+            nk_chart_push_slot(ctx, m_frameBudget, 3);
+        }
+        nk_chart_end(ctx);
     }
-    m_logs.push_back(log);
+    nk_tree_pop(ctx);
+}
+
+void Debugger::updateFrameStats() {
+    auto& stats = m_frameStats;
+    const int count = static_cast<int>(glm::min<uint64_t>(m_frameCount, FRAME_HISTORY));
+    stats.count = count;
+
+    float FrameTiming::*fields[] = {&FrameTiming::frame, &FrameTiming::update,
+                                    &FrameTiming::render};
+    const float ranks[] = {0.50f, 0.95f, 0.99f, 1.0f};
+    m_frameScratch.resize(count);
+    for (int row = 0; row < 3; row++) {
+        for (int i = 0; i < count; i++) {
+            m_frameScratch[i] = m_frames[i].*fields[row];
+        }
+        for (int column = 0; column < 4; column++) {
+            float value = 0.0f;
+            if (count > 0) {
+                auto nth = m_frameScratch.begin() + static_cast<int>(ranks[column] * (count - 1));
+                std::nth_element(m_frameScratch.begin(), nth, m_frameScratch.end());
+                value = *nth;
+            }
+            stats.percentiles[row][column] = value;
+        }
+    }
+
+    stats.overBudget = 0;
+    for (int i = 0; i < count; i++) {
+        stats.overBudget += m_frames[i].frame > m_frameBudget;
+    }
+
+    Uint64 overlayFrames = 0;
+    Uint64 cachedFrames = 0;
+    nk_sdl_render_stats(&overlayFrames, &cachedFrames);
+    stats.overlayReuse = overlayFrames ? static_cast<int>(cachedFrames * 100 / overlayFrames) : 0;
+
+    const int shown = glm::min(count, FRAME_CHART);
+    stats.chartMax = m_frameBudget * 2.0f;
+    m_frameChart.resize(shown);
+    for (int i = 0; i < shown; i++) {
+        m_frameChart[i] = m_frames[(m_frameCount - shown + i) % FRAME_HISTORY];
+        stats.chartMax = glm::max(stats.chartMax, m_frameChart[i].frame);
+    }
+}
+
+void Debugger::profiler() {
+    auto ctx = m_ctx.get();
+    if (!nk_tree_push(ctx, NK_TREE_TAB, "PROFILER", NK_MINIMIZED)) {
+        return;
+    }
+
+    Profiler::Frame frame;
+    bool hasFrame = Profiler::lastFrame(frame);
+
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT, 3);
+    nk_bool paused = Profiler::paused();
+    nk_checkbox_label(ctx, "pause", &paused);
+    Profiler::setPaused(paused);
+    if (nk_button_label(ctx, "dump trace")) {
+        Profiler::writeChromeTrace(prefPath("trace.json").c_str());
+    }
+    nk_labelf(ctx, NK_TEXT_RIGHT, "%.2f ms",
+              hasFrame ? Profiler::toMilliseconds(frame.end - frame.start) : 0.0);
+
+    m_profilerEvents.clear();
+    if (hasFrame) {
+        Profiler::collect(frame, m_profilerEvents);
+    }
+    if (m_profilerEvents.empty()) {
+        nk_tree_pop(ctx);
+        return;
+    }
+
+    // Flame view: one lane per call depth and thread, time on the x axis
+    uint32_t lanes = 0;
+    uint32_t threads = 0;
+    for (const auto& event : m_profilerEvents) {
+        lanes = glm::max(lanes, event.depth + 1);
+        threads = glm::max(threads, event.thread + 1);
+    }
+
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT * lanes * threads, 1);
+    struct nk_rect bounds;
+    if (nk_widget(&bounds, ctx) == NK_WIDGET_INVALID) {
+        nk_tree_pop(ctx);
+        return;
+    }
+    auto canvas = nk_window_get_canvas(ctx);
+    nk_fill_rect(canvas, bounds, 0, nk_rgba(20, 22, 28, 255));
+
+    const auto font = ctx->style.font;
+    const auto duration = glm::max<uint64_t>(frame.end - frame.start, 1);
+    const float scale = bounds.w / static_cast<float>(duration);
+    const Profiler::Event* hovered = nullptr;
+    for (const auto& event : m_profilerEvents) {
+        auto lane = event.thread * lanes + event.depth;
+        float x = bounds.x + (event.start - frame.start) * scale;
+        float w = glm::max((event.end - event.start) * scale, 1.0f);
+        struct nk_rect rect = nk_rect(x, bounds.y + lane * ROW_HEIGHT, w, ROW_HEIGHT - 1);
+        // The name is a literal, so its address is a stable color key
+        auto hash = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(event.name) * 2654435761u);
+        struct nk_color color =
+            nk_rgba(100 + (hash >> 8) % 130, 60 + (hash >> 16) % 100, 40 + (hash >> 24) % 60, 255);
+        nk_fill_rect(canvas, rect, 0, color);
+        if (rect.w > 24) {
+            auto length = static_cast<int>(strlen(event.name));
+            auto white = nk_rgba(255, 255, 255, 255);
+            nk_draw_text(canvas, rect, event.name, length, font, color, white);
+        }
+        if (nk_input_is_mouse_hovering_rect(&ctx->input, rect)) {
+            hovered = &event;
+        }
+    }
+    if (hovered) {
+        nk_tooltipf(ctx, "%s: %.3f ms", hovered->name,
+                    Profiler::toMilliseconds(hovered->end - hovered->start));
+    }
+    nk_tree_pop(ctx);
+}
+
+void Debugger::log(const char* log) {
+    std::lock_guard lock(m_logMutex);
+    SDL_strlcpy(m_logs[m_logCount % LOG_LINES].data(), log, LOG_LINE_LENGTH);
+    m_logCount++;
 }
 
 bool Debugger::pushSection(const char* name) {
@@ -246,6 +626,183 @@ void Debugger::texture(SDL_Texture* ptr) {
     nk_image(ctx, nk_image_ptr(ptr));
 }
 
+int Debugger::list(const char* name,
+                   int count,
+                   const std::function<void(int, ListRow&)>& row) {
+    auto ctx = m_ctx.get();
+    auto it = m_listSelection.find(std::string_view(name));
+    if (it == m_listSelection.end()) {
+        it = m_listSelection.emplace(name, ListSelection{}).first;
+    }
+    auto& selection = it->second;
+    if (selection.id != 0 && selection.index >= 0) {
+        auto rowId = [&](int index) {
+            ListRow item;
+            item.text[0] = '\0';
+            row(index, item);
+            return item.id;
+        };
+        // Searched only when the row is not where it was, e.g. after rows were removed
+        if (selection.index >= count || rowId(selection.index) != selection.id) {
+            selection.index = -1;
+            for (int index = 0; index < count; index++) {
+                if (rowId(index) == selection.id) {
+                    selection.index = index;
+                    break;
+                }
+            }
+            if (selection.index < 0) {
+                // Gone, do not search again
+                selection.id = 0;
+            }
+        }
+    }
+    if (selection.index >= count) {
+        selection.index = -1;
+    }
+    int& selected = selection.index;
+
+    struct nk_list_view view;
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT * 10 * 1.2, 1);
+    if (nk_list_view_begin(ctx, &view, name, NK_WINDOW_BORDER, ROW_HEIGHT, count)) {
+        for (int i = 0; i < view.count; ++i) {
+            const int index = view.begin + i;
+            ListRow item;
+            item.text[0] = '\0';
+            row(index, item);
+
+            if (item.texture) {
+                nk_layout_row_template_begin(ctx, ROW_HEIGHT);
+                nk_layout_row_template_push_static(ctx, ROW_HEIGHT);
+                nk_layout_row_template_push_dynamic(ctx);
+                nk_layout_row_template_end(ctx);
+                const int slot = thumbnail(item.texture, item.textureVersion, item.textureSize);
+                if (slot >= 0) {
+                    const float x = (slot % THUMBNAIL_COLUMNS) * THUMBNAIL_SIZE;
+                    const float y = (slot / THUMBNAIL_COLUMNS) * THUMBNAIL_SIZE;
+                    nk_image(ctx, nk_subimage_ptr(m_thumbnailAtlas, THUMBNAIL_ATLAS_SIZE,
+                                                  THUMBNAIL_ATLAS_SIZE,
+                                                  nk_rect(x, y, THUMBNAIL_SIZE, THUMBNAIL_SIZE)));
+                } else {
+                    nk_image(ctx, nk_image_ptr(item.texture));
+                }
+            } else {
+                nk_layout_row_dynamic(ctx, ROW_HEIGHT, 1);
+            }
+            nk_bool active = index == selected;
+            if (nk_selectable_label(ctx, item.text, NK_TEXT_LEFT, &active)) {
+                selected = active ? index : -1;
+                selection.id = active ? item.id : 0;
+            }
+        }
+        nk_list_view_end(&view);
+    }
+    return selected;
+}
+
+int Debugger::tableHeader(const char* name,
+                          std::span<const char* const> columns,
+                          int sortColumn) {
+    auto ctx = m_ctx.get();
+    auto it = m_tableSort.find(std::string_view(name));
+    if (it == m_tableSort.end()) {
+        it = m_tableSort.emplace(name, sortColumn).first;
+    }
+    tableLayout(static_cast<int>(columns.size()));
+    for (int i = 0; i < static_cast<int>(columns.size()); i++) {
+        nk_bool active = i == it->second;
+        if (nk_selectable_label(ctx, columns[i], i == 0 ? NK_TEXT_LEFT : NK_TEXT_RIGHT,
+                                &active)) {
+            it->second = i;
+        }
+    }
+    return it->second;
+}
+
+void Debugger::tableRow(std::span<const char* const> cells) {
+    auto ctx = m_ctx.get();
+    tableLayout(static_cast<int>(cells.size()));
+    for (int i = 0; i < static_cast<int>(cells.size()); i++) {
+        nk_label(ctx, cells[i], i == 0 ? NK_TEXT_LEFT : NK_TEXT_RIGHT);
+    }
+}
+
+void Debugger::tableLayout(int columns) {
+    // nuklear keeps the pointer until the row is done, the first column gets three shares
+    m_tableRatios.assign(columns, 1.0f / (columns + 2));
+    if (columns > 0) {
+        m_tableRatios[0] = 3.0f / (columns + 2);
+    }
+    nk_layout_row(m_ctx.get(), NK_DYNAMIC, ROW_HEIGHT, columns, m_tableRatios.data());
+}
+
+int Debugger::thumbnail(SDL_Texture* texture, uint32_t version, Size size) {
+    if (!m_thumbnailAtlas) {
+        return -1;
+    }
+    // Least recently used slot not shown this frame
+    int slot = -1;
+    for (int i = 0; i < static_cast<int>(m_thumbnails.size()); i++) {
+        auto& thumbnail = m_thumbnails[i];
+        if (thumbnail.texture == texture && thumbnail.version == version &&
+            thumbnail.size == size) {
+            thumbnail.lastUsed = m_uiFrame;
+            return i;
+        }
+        if (thumbnail.lastUsed < m_uiFrame &&
+            (slot < 0 || thumbnail.lastUsed < m_thumbnails[slot].lastUsed)) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        m_thumbnails[slot] = {texture, version, size, m_uiFrame};
+        m_thumbnailQueue.push_back(slot);
+    }
+    return slot;
+}
+
+void Debugger::drawThumbnails() {
+    if (m_thumbnailQueue.empty()) {
+        return;
+    }
+    SDL_Texture* target = SDL_GetRenderTarget(m_renderer);
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(m_renderer, &blendMode);
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(m_renderer, &r, &g, &b, &a);
+
+    SDL_SetRenderTarget(m_renderer, m_thumbnailAtlas);
+    SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
+    for (int slot : m_thumbnailQueue) {
+        const auto& thumbnail = m_thumbnails[slot];
+        const SDL_FRect cell = {static_cast<float>((slot % THUMBNAIL_COLUMNS) * THUMBNAIL_SIZE),
+                                static_cast<float>((slot / THUMBNAIL_COLUMNS) * THUMBNAIL_SIZE),
+                                THUMBNAIL_SIZE, THUMBNAIL_SIZE};
+        SDL_RenderFillRect(m_renderer, &cell);
+
+        // Centered in the cell, keeping the aspect ratio, without the tint of the last sprite
+        const float longest = glm::max(glm::max(thumbnail.size.x, thumbnail.size.y), 1.0f);
+        const float scale = THUMBNAIL_SIZE / longest;
+        const Size size = thumbnail.size * scale;
+        const SDL_FRect dst = {cell.x + (THUMBNAIL_SIZE - size.x) / 2,
+                               cell.y + (THUMBNAIL_SIZE - size.y) / 2, size.x, size.y};
+        Uint8 modR, modG, modB, modA;
+        SDL_GetTextureColorMod(thumbnail.texture, &modR, &modG, &modB);
+        SDL_GetTextureAlphaMod(thumbnail.texture, &modA);
+        SDL_SetTextureColorMod(thumbnail.texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(thumbnail.texture, 255);
+        SDL_RenderTexture(m_renderer, thumbnail.texture, nullptr, &dst);
+        SDL_SetTextureColorMod(thumbnail.texture, modR, modG, modB);
+        SDL_SetTextureAlphaMod(thumbnail.texture, modA);
+    }
+    m_thumbnailQueue.clear();
+
+    SDL_SetRenderTarget(m_renderer, target);
+    SDL_SetRenderDrawBlendMode(m_renderer, blendMode);
+    SDL_SetRenderDrawColor(m_renderer, r, g, b, a);
+}
+
 bool Debugger::value(const char* key, bool& value) {
     auto ctx = m_ctx.get();
     nk_layout_row_dynamic(ctx, ROW_HEIGHT, 2);
@@ -255,3 +812,33 @@ bool Debugger::value(const char* key, bool& value) {
     value = active;
     return value;
 }
+
+void Debugger::label(const char* key, const char* format, ...) {
+    auto ctx = m_ctx.get();
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT, 2);
+    nk_label(ctx, key, NK_TEXT_LEFT);
+    va_list args;
+    va_start(args, format);
+    nk_labelfv(ctx, NK_TEXT_LEFT, format, args);
+    va_end(args);
+}
+
+void Debugger::plot(const char* name, std::span<const float> values, int offset) {
+    auto ctx = m_ctx.get();
+    const int count = static_cast<int>(values.size());
+    float max = 0.0f;
+    for (auto value : values) {
+        max = glm::max(max, value);
+    }
+
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT, 2);
+    nk_label(ctx, name, NK_TEXT_LEFT);
+    nk_labelf(ctx, NK_TEXT_LEFT, "max %.1f", max);
+    nk_layout_row_dynamic(ctx, ROW_HEIGHT * 4, 1);
+    if (nk_chart_begin(ctx, NK_CHART_LINES, count, 0.0f, max > 0.0f ? max : 1.0f)) {
+        for (int i = 0; i < count; i++) {
+            nk_chart_push(ctx, values[(offset + i) % count]);
+        }
+        nk_chart_end(ctx);
+    }
+}
@@ -2,18 +2,38 @@
 
 #include <SDL3/SDL.h>
 
+#include <array>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <tuple>
 #include <vector>
 
 #include "context.hpp"
 #include "math.hpp"
+#include "profiler.hpp"
 
 struct nk_context;
 
 class Debugger {
   public:
+    // One row of a list, optionally with a thumbnail of a texture. The version tells apart
+    // textures that reuse the pointer of a deleted one.
+    struct ListRow {
+        char text[128];
+        // Identifies the row across frames, the selection follows it when rows move. 0 keeps the
+        // selection by index.
+        uint64_t id = 0;
+        SDL_Texture* texture = nullptr;
+        uint32_t textureVersion = 0;
+        Size textureSize{0, 0};
+    };
+
+    Debugger() = default;
+    ~Debugger();
     void init(SDL_Window* win, SDL_Renderer* renderer);
     void event(const SDL_Event* event);
     void update();
@@ -21,22 +41,108 @@ class Debugger {
     void postUpdate(const UpdateContext& context);
     void render();
 
+    // Thread safe, keeps the last LOG_LINES lines without allocating
     void log(const char* log);
+    // Durations of the last frame in milliseconds: the whole frame interval and its update and
+    // render parts
+    void pushFrame(float frameMs, float updateMs, float renderMs);
+    void setFrameBudget(float budgetMs) {
+        m_frameBudget = budgetMs;
+    }
 
     bool pushSection(const char* name);
     void popSection();
     void texture(SDL_Texture* ptr);
+    // A scrolling list of count rows of which only those in view are built, by row(index, row),
+    // so it costs the same for ten rows or 100k. Clicking a row selects it, the selection is
+    // kept by name and follows the row's id. Returns the selected row or -1.
+    int list(const char* name, int count, const std::function<void(int, ListRow&)>& row);
+    // A table sorted by the column whose title was clicked last, kept by name: tableHeader()
+    // draws the titles and returns that column, the caller sorts its rows and adds them as
+    // formatted cells with tableRow(). The first column is wider, for names.
+    int tableHeader(const char* name, std::span<const char* const> columns, int sortColumn = 0);
+    void tableRow(std::span<const char* const> cells);
 
     bool active() const {
         return m_windowShown;
     };
 
     bool value(const char* key, bool& value);
+    // A "key: value" row, value is printf formatted
+    void label(const char* key, SDL_PRINTF_FORMAT_STRING const char* format, ...)
+        SDL_PRINTF_VARARG_FUNC(3);
+    // A line chart of a ring buffer of values, starting at offset
+    void plot(const char* name, std::span<const float> values, int offset = 0);
 
   private:
+    struct FrameTiming {
+        float frame;
+        float update;
+        float render;
+    };
+    static constexpr int FRAME_HISTORY = 4096;
+    // Frames in the FRAME section's chart
+    static constexpr int FRAME_CHART = 240;
+    static constexpr uint64_t FRAME_STATS_INTERVAL_MS = 250;
+    static constexpr int LOG_LINES = 64;
+    static constexpr int LOG_LINE_LENGTH = 160;
+    static constexpr int THUMBNAIL_SIZE = 32;
+    static constexpr int THUMBNAIL_ATLAS_SIZE = 512;
+    static constexpr int THUMBNAIL_COLUMNS = THUMBNAIL_ATLAS_SIZE / THUMBNAIL_SIZE;
+
+    // What the FRAME section shows, as of the last refresh
+    struct FrameStats {
+        int count = 0;
+        // p50, p95, p99 and max of the frame, update and render durations
+        std::array<std::array<float, 4>, 3> percentiles{};
+        int overBudget = 0;
+        // Percentage of frames nk_sdl_render drew from its cached target
+        int overlayReuse = 0;
+        float chartMax = 0.0f;
+    };
+
+    struct ListSelection {
+        int index = -1;
+        uint64_t id = 0;
+    };
+
+    struct Thumbnail {
+        SDL_Texture* texture = nullptr;
+        uint32_t version = 0;
+        Size size{0, 0};
+        uint64_t lastUsed = 0;
+    };
+
+    void frames();
+    void updateFrameStats();
+    void profiler();
+    // Slot of the texture in the thumbnail atlas, new ones are drawn by render(). -1 without an
+    // atlas or when every slot is in use this frame.
+    int thumbnail(SDL_Texture* texture, uint32_t version, Size size);
+    void drawThumbnails();
+    void tableLayout(int columns);
+
     std::unique_ptr<nk_context, void (*)(nk_context*)> m_ctx{nullptr, nullptr};
     std::vector<std::tuple<std::string, std::string>> m_values;
-    std::vector<std::string> m_logs;
+    std::array<std::array<char, LOG_LINE_LENGTH>, LOG_LINES> m_logs{};
+    uint64_t m_logCount = 0;
+    std::mutex m_logMutex;
+    std::vector<Profiler::Event> m_profilerEvents;
+    std::array<FrameTiming, FRAME_HISTORY> m_frames{};
+    std::vector<float> m_frameScratch;
+    FrameStats m_frameStats;
+    std::vector<FrameTiming> m_frameChart;
+    uint64_t m_frameStatsRefresh = 0;
+    uint64_t m_frameCount = 0;
+    float m_frameBudget = 1000.0f / 60.0f;
+    SDL_Renderer* m_renderer = nullptr;
+    SDL_Texture* m_thumbnailAtlas = nullptr;
+    std::array<Thumbnail, THUMBNAIL_COLUMNS * THUMBNAIL_COLUMNS> m_thumbnails{};
+    std::vector<int> m_thumbnailQueue;
+    uint64_t m_uiFrame = 0;
+    std::map<std::string, ListSelection, std::less<>> m_listSelection;
+    std::map<std::string, int, std::less<>> m_tableSort;
+    std::vector<float> m_tableRatios;
     bool m_windowShown = true;
     bool m_toggleWindow = false;
     Size m_windowSize{0, 0};
@@ -0,0 +1,549 @@
+#include "flight_recorder.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "misc.hpp"
+#include "profiler.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define Q14_CRASH_HANDLER
+#include <csignal>
+#endif
+
+namespace {
+
+constexpr int FRAME_COUNT = 120;
+constexpr int COUNTERS_PER_FRAME = 16;
+constexpr int LOG_LINES = 128;
+constexpr int LOG_LINE_LENGTH = 160;
+constexpr int LOG_WORDS = LOG_LINE_LENGTH / 8;
+constexpr int REASON_LENGTH = 64;
+constexpr int SPIKE_FILES = 4;
+constexpr double SPIKE_COOLDOWN_MS = 5000.0;
+// Profiler events per dump, the oldest ones in the window are left out when there are more
+constexpr size_t EVENT_CAPACITY = 4096;
+
+struct Counter {
+    const char* name;
+    double value;
+};
+
+struct FrameRecord {
+    uint64_t index;
+    uint64_t start;
+    uint64_t end;
+    int counterCount;
+    Counter counters[COUNTERS_PER_FRAME];
+};
+
+// A log line in atomic words, published through a sequence number like the profiler's events:
+// odd while it is written, 2 * (index + 1) once line index is complete. The dump thread and the
+// crash handler read it without a lock and skip lines that change meanwhile.
+struct LogLine {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> time{0};
+    std::atomic<uint64_t> words[LOG_WORDS];
+};
+
+// The frames of one dump, copied by the thread that owns them, and when they were copied. Log
+// lines and profiler events are read from their rings while writing.
+struct Snapshot {
+    char reason[REASON_LENGTH];
+    uint64_t now;
+    int frameCount;
+    FrameRecord frames[FRAME_COUNT];
+};
+
+// Written by the main thread only, the open frame is s_frames[s_frameIndex % FRAME_COUNT]
+FrameRecord s_frames[FRAME_COUNT];
+uint64_t s_frameIndex = 0;
+bool s_frameOpen = false;
+
+LogLine s_logs[LOG_LINES];
+std::atomic<uint64_t> s_logHead{0};
+
+uint64_t s_frequency = 1;
+uint64_t s_budgetTicks = 0;
+uint64_t s_lastDump = 0;
+int s_spikeCount = 0;
+
+// Spike dumps are written by a thread of their own, one at a time
+std::string s_spikePaths[SPIKE_FILES];
+Snapshot s_spikeSnapshot;
+int s_spikeFile = 0;
+std::vector<Profiler::Event> s_spikeEvents;
+std::mutex s_dumpMutex;
+std::condition_variable s_dumpRequested;
+std::atomic<bool> s_dumpPending{false};
+bool s_dumpRunning = false;
+SDL_Thread* s_dumpThread = nullptr;
+
+int openFile(const char* path) {
+#ifdef _WIN32
+    return _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+bool closeFile(int fd) {
+#ifdef _WIN32
+    return _close(fd) == 0;
+#else
+    return close(fd) == 0;
+#endif
+}
+
+// Buffered output through the file descriptor, without allocations or locks, so the crash handler
+// can use it too. Numbers are formatted by hand, printf is not async-signal-safe.
+class TraceWriter {
+  public:
+    explicit TraceWriter(int fd) : m_fd(fd) {
+    }
+
+    void raw(const char* str) {
+        for (; *str; str++) {
+            put(*str);
+        }
+    }
+
+    void escaped(const char* str) {
+        for (; *str; str++) {
+            if (*str == '"' || *str == '\\') {
+                put('\\');
+            }
+            // Log lines end in newlines, control characters are not valid in JSON strings
+            put(static_cast<unsigned char>(*str) < 0x20 ? ' ' : *str);
+        }
+    }
+
+    void integer(uint64_t value) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (count > 0) {
+            put(digits[--count]);
+        }
+    }
+
+    // Three decimals, non-finite values as 0
+    void number(double value) {
+        if (!std::isfinite(value)) {
+            value = 0.0;
+        }
+        if (value < 0.0) {
+            put('-');
+            value = -value;
+        }
+        const auto thousandths = static_cast<uint64_t>(std::fmin(value, 1e15) * 1000.0 + 0.5);
+        integer(thousandths / 1000);
+        put('.');
+        const auto fraction = thousandths % 1000;
+        put(static_cast<char>('0' + fraction / 100));
+        put(static_cast<char>('0' + fraction / 10 % 10));
+        put(static_cast<char>('0' + fraction % 10));
+    }
+
+    // Writes what is buffered, false if any write failed
+    bool flush() {
+        const char* data = m_buffer;
+        size_t size = m_size;
+        while (size > 0 && !m_failed) {
+#ifdef _WIN32
+            auto written = _write(m_fd, data, static_cast<unsigned>(size));
+#else
+            auto written = write(m_fd, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if (written <= 0) {
+                m_failed = true;
+                break;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        m_size = 0;
+        return !m_failed;
+    }
+
+  private:
+    void put(char c) {
+        if (m_size == sizeof(m_buffer)) {
+            flush();
+        }
+        m_buffer[m_size++] = c;
+    }
+
+    int m_fd;
+    char m_buffer[4096];
+    size_t m_size = 0;
+    bool m_failed = false;
+};
+
+// Copies the recorded frames, the open one ends now. Main thread, or the crash handler, which may
+// see a frame the main thread is writing only partly updated.
+void takeSnapshot(Snapshot& snapshot, const char* reason) {
+    snapshot.now = SDL_GetPerformanceCounter();
+    SDL_strlcpy(snapshot.reason, reason, sizeof(snapshot.reason));
+    snapshot.frameCount = 0;
+    if (!s_frameOpen) {
+        return;
+    }
+    const uint64_t first = s_frameIndex + 1 > FRAME_COUNT ? s_frameIndex + 1 - FRAME_COUNT : 0;
+    for (uint64_t i = first; i <= s_frameIndex; i++) {
+        auto& frame = snapshot.frames[snapshot.frameCount++];
+        std::memcpy(&frame, &s_frames[i % FRAME_COUNT], sizeof(FrameRecord));
+        if (frame.end <= frame.start) {
+            frame.end = snapshot.now;
+        }
+        frame.counterCount = SDL_clamp(frame.counterCount, 0, COUNTERS_PER_FRAME);
+    }
+}
+
+bool readLogLine(uint64_t index, uint64_t& time, char (&text)[LOG_LINE_LENGTH + 1]) {
+    const auto& line = s_logs[index % LOG_LINES];
+    const uint64_t sequence = 2 * (index + 1);
+    if (line.sequence.load(std::memory_order_acquire) != sequence) {
+        return false;
+    }
+    time = line.time.load(std::memory_order_acquire);
+    uint64_t words[LOG_WORDS];
+    for (int i = 0; i < LOG_WORDS; i++) {
+        words[i] = line.words[i].load(std::memory_order_acquire);
+    }
+    std::memcpy(text, words, LOG_LINE_LENGTH);
+    text[LOG_LINE_LENGTH] = '\0';
+    return line.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+// The snapshot's frames and counters, the profiler events and the log lines since its first frame
+// as a Chrome trace. Async-signal-safe, events is caller-owned scratch memory.
+bool writeTrace(int fd, const Snapshot& snapshot, std::span<Profiler::Event> events) {
+    TraceWriter out(fd);
+    const uint64_t base = snapshot.frameCount > 0 ? snapshot.frames[0].start : snapshot.now;
+    const double toMicroseconds = 1e6 / static_cast<double>(s_frequency);
+    auto timestamp = [&](uint64_t ticks) {
+        return ticks > base ? static_cast<double>(ticks - base) * toMicroseconds : 0.0;
+    };
+    auto beginEvent = [&](const char* name, const char* phase, uint64_t ticks) {
+        out.raw(",\n{\"name\": \"");
+        out.escaped(name);
+        out.raw("\", \"ph\": \"");
+        out.raw(phase);
+        out.raw("\", \"pid\": 0, \"ts\": ");
+        out.number(timestamp(ticks));
+    };
+
+    out.raw("{\"displayTimeUnit\": \"ms\", \"otherData\": {\"reason\": \"");
+    out.escaped(snapshot.reason);
+    out.raw("\"}, \"traceEvents\": [\n{\"name\": \"");
+    out.escaped(snapshot.reason);
+    out.raw("\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 0, \"tid\": 0, \"ts\": ");
+    out.number(timestamp(snapshot.now));
+    out.raw("}");
+
+    for (int i = 0; i < snapshot.frameCount; i++) {
+        const auto& frame = snapshot.frames[i];
+        beginEvent("Frame", "X", frame.start);
+        out.raw(", \"tid\": 0, \"dur\": ");
+        out.number(static_cast<double>(frame.end - frame.start) * toMicroseconds);
+        out.raw(", \"args\": {\"index\": ");
+        out.integer(frame.index);
+        out.raw("}}");
+        for (int c = 0; c < frame.counterCount; c++) {
+            beginEvent(frame.counters[c].name, "C", frame.start);
+            out.raw(", \"args\": {\"value\": ");
+            out.number(frame.counters[c].value);
+            out.raw("}}");
+        }
+    }
+
+    const size_t eventCount = Profiler::copyEvents(base, events);
+    for (size_t i = 0; i < eventCount; i++) {
+        const auto& event = events[i];
+        if (event.start > snapshot.now) {
+            continue;
+        }
+        beginEvent(event.name, "X", event.start);
+        out.raw(", \"tid\": ");
+        out.integer(event.thread);
+        out.raw(", \"dur\": ");
+        out.number(static_cast<double>(event.end - event.start) * toMicroseconds);
+        out.raw("}");
+    }
+
+    const uint64_t head = s_logHead.load(std::memory_order_acquire);
+    for (uint64_t i = head > LOG_LINES ? head - LOG_LINES : 0; i < head; i++) {
+        uint64_t time;
+        char text[LOG_LINE_LENGTH + 1];
+        if (!readLogLine(i, time, text) || time < base || time > snapshot.now) {
+            continue;
+        }
+        beginEvent(text, "i", time);
+        out.raw(", \"s\": \"g\", \"tid\": 0}");
+    }
+
+    out.raw("\n]}\n");
+    return out.flush();
+}
+
+bool writeFile(const char* path, const Snapshot& snapshot, std::span<Profiler::Event> events) {
+    int fd = openFile(path);
+    if (fd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FlightRecorder: could not open %s", path);
+        return false;
+    }
+    bool ok = writeTrace(fd, snapshot, events);
+    ok = closeFile(fd) && ok;
+    if (ok) {
+        SDL_Log("FlightRecorder: %s, wrote %s", snapshot.reason, path);
+    } else {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FlightRecorder: could not write %s", path);
+    }
+    return ok;
+}
+
+int dumpThread(void*) {
+    std::unique_lock lock(s_dumpMutex);
+    for (;;) {
+        s_dumpRequested.wait(lock, [] { return !s_dumpRunning || s_dumpPending.load(); });
+        if (!s_dumpRunning) {
+            return 0;
+        }
+        lock.unlock();
+        writeFile(s_spikePaths[s_spikeFile].c_str(), s_spikeSnapshot, s_spikeEvents);
+        lock.lock();
+        s_dumpPending.store(false, std::memory_order_release);
+    }
+}
+
+#ifdef Q14_CRASH_HANDLER
+
+constexpr int SIGNALS[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+// The handler runs on it, so stack overflows on the main thread are dumped too
+constexpr size_t ALT_STACK_SIZE = 64 * 1024;
+
+// Everything the handler needs is prepared up front: it writes into a file opened by init and
+// renames it into place, both async-signal-safe
+int s_crashFd = -1;
+std::string s_crashTempPath;
+std::string s_crashPath;
+Snapshot s_crashSnapshot;
+Profiler::Event s_crashEvents[EVENT_CAPACITY];
+alignas(16) char s_altStack[ALT_STACK_SIZE];
+stack_t s_previousAltStack;
+struct sigaction s_previousActions[std::size(SIGNALS)];
+bool s_installed = false;
+
+void onSignal(int signal) {
+    // SA_RESETHAND restored the default action, so a crash while dumping ends the process
+    const int fd = s_crashFd;
+    s_crashFd = -1;
+    if (fd >= 0) {
+        char reason[16] = "signal ";
+        int length = 7;
+        if (signal >= 10) {
+            reason[length++] = static_cast<char>('0' + signal / 10 % 10);
+        }
+        reason[length++] = static_cast<char>('0' + signal % 10);
+        reason[length] = '\0';
+        takeSnapshot(s_crashSnapshot, reason);
+        writeTrace(fd, s_crashSnapshot, s_crashEvents);
+        close(fd);
+        rename(s_crashTempPath.c_str(), s_crashPath.c_str());
+    }
+    // Delivered with the default action once the handler returns
+    raise(signal);
+}
+
+void installCrashHandler() {
+    if (s_installed) {
+        return;
+    }
+    s_crashPath = prefPath("crash.json");
+    s_crashTempPath = prefPath("crash.tmp");
+    s_crashFd = openFile(s_crashTempPath.c_str());
+    if (s_crashFd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FlightRecorder: could not open %s",
+                     s_crashTempPath.c_str());
+        return;
+    }
+
+    stack_t altStack{};
+    altStack.ss_sp = s_altStack;
+    altStack.ss_size = sizeof(s_altStack);
+    sigaltstack(&altStack, &s_previousAltStack);
+
+    struct sigaction action{};
+    action.sa_handler = onSignal;
+    action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < std::size(SIGNALS); i++) {
+        sigaction(SIGNALS[i], &action, &s_previousActions[i]);
+    }
+    s_installed = true;
+}
+
+void removeCrashHandler() {
+    if (!s_installed) {
+        return;
+    }
+    for (size_t i = 0; i < std::size(SIGNALS); i++) {
+        sigaction(SIGNALS[i], &s_previousActions[i], nullptr);
+    }
+    sigaltstack(&s_previousAltStack, nullptr);
+    if (s_crashFd >= 0) {
+        close(s_crashFd);
+        s_crashFd = -1;
+        unlink(s_crashTempPath.c_str());
+    }
+    s_installed = false;
+}
+
+#else
+
+void installCrashHandler() {
+}
+
+void removeCrashHandler() {
+}
+
+#endif
+
+}  // namespace
+
+void FlightRecorder::init(float spikeBudgetMs) {
+    s_frequency = SDL_GetPerformanceFrequency();
+    s_budgetTicks =
+        static_cast<uint64_t>(spikeBudgetMs / 1000.0 * static_cast<double>(s_frequency));
+    installCrashHandler();
+    if (s_budgetTicks == 0 || s_dumpThread) {
+        return;
+    }
+    for (int i = 0; i < SPIKE_FILES; i++) {
+        char file[32];
+        std::snprintf(file, sizeof(file), "spike_%d.json", i);
+        s_spikePaths[i] = prefPath(file);
+    }
+    s_spikeEvents.resize(EVENT_CAPACITY);
+    s_dumpRunning = true;
+    s_dumpThread = SDL_CreateThread(dumpThread, "q14-flight-recorder", nullptr);
+    if (!s_dumpThread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FlightRecorder: no dump thread, %s",
+                     SDL_GetError());
+        s_dumpRunning = false;
+    }
+}
+
+void FlightRecorder::shutdown() {
+    removeCrashHandler();
+    if (!s_dumpThread) {
+        return;
+    }
+    {
+        std::lock_guard lock(s_dumpMutex);
+        s_dumpRunning = false;
+    }
+    s_dumpRequested.notify_all();
+    SDL_WaitThread(s_dumpThread, nullptr);
+    s_dumpThread = nullptr;
+}
+
+void FlightRecorder::beginFrame() {
+    const uint64_t now = SDL_GetPerformanceCounter();
+    if (s_frameOpen) {
+        auto& frame = s_frames[s_frameIndex % FRAME_COUNT];
+        frame.end = now;
+        const uint64_t ticks = frame.end - frame.start;
+        const bool cooledDown = s_spikeCount == 0 ||
+                                Profiler::toMilliseconds(now - s_lastDump) > SPIKE_COOLDOWN_MS;
+        // The previous dump may still be writing, then this spike is skipped
+        if (s_dumpThread && s_budgetTicks > 0 && ticks > s_budgetTicks && cooledDown &&
+            !s_dumpPending.load(std::memory_order_acquire)) {
+            char reason[REASON_LENGTH];
+            std::snprintf(reason, sizeof(reason), "frame %llu took %.1f ms",
+                          static_cast<unsigned long long>(frame.index),
+                          Profiler::toMilliseconds(ticks));
+            takeSnapshot(s_spikeSnapshot, reason);
+            s_spikeFile = s_spikeCount % SPIKE_FILES;
+            {
+                std::lock_guard lock(s_dumpMutex);
+                s_dumpPending.store(true, std::memory_order_release);
+            }
+            s_dumpRequested.notify_one();
+            s_spikeCount++;
+            s_lastDump = now;
+        }
+        s_frameIndex++;
+    }
+    auto& frame = s_frames[s_frameIndex % FRAME_COUNT];
+    frame.index = s_frameIndex;
+    frame.start = now;
+    frame.end = 0;
+    frame.counterCount = 0;
+    s_frameOpen = true;
+}
+
+void FlightRecorder::counter(const char* name, double value) {
+    if (!s_frameOpen) {
+        return;
+    }
+    auto& frame = s_frames[s_frameIndex % FRAME_COUNT];
+    for (int i = 0; i < frame.counterCount; i++) {
+        if (frame.counters[i].name == name) {
+            frame.counters[i].value = value;
+            return;
+        }
+    }
+    if (frame.counterCount < COUNTERS_PER_FRAME) {
+        frame.counters[frame.counterCount++] = {name, value};
+    }
+}
+
+void FlightRecorder::log(const char* line) {
+    const uint64_t time = SDL_GetPerformanceCounter();
+    uint64_t words[LOG_WORDS] = {};
+    SDL_strlcpy(reinterpret_cast<char*>(words), line, sizeof(words));
+
+    const uint64_t index = s_logHead.fetch_add(1, std::memory_order_acq_rel);
+    auto& entry = s_logs[index % LOG_LINES];
+    entry.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    entry.time.store(time, std::memory_order_release);
+    for (int i = 0; i < LOG_WORDS; i++) {
+        entry.words[i].store(words[i], std::memory_order_release);
+    }
+    entry.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+bool FlightRecorder::dump(const char* path, const char* reason) {
+    auto snapshot = std::make_unique<Snapshot>();
+    std::vector<Profiler::Event> events(EVENT_CAPACITY);
+    takeSnapshot(*snapshot, reason);
+    return writeFile(path, *snapshot, events);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Keeps the last frames: their times, counters such as draw calls and physics bodies, and the log
+// lines written meanwhile, next to the scopes the Profiler records. When a frame takes longer than
+// the budget the window is dumped as a Chrome trace to spike_<n>.json in the pref path, and on a
+// crash signal (SIGSEGV, SIGABRT, ...) to crash.json.
+//
+//   FlightRecorder::counter("drawCalls", stats.drawCalls);
+//
+// Recording costs a few stores per counter and a copy per log line, so it stays on in release
+// builds. A spike costs the main thread a copy of the frame ring, the file is written by a thread
+// of its own, at most one per SPIKE_COOLDOWN_MS. The crash handler is async-signal-safe: it writes
+// into a file opened up front, on an alternate stack (the main thread's), without locks. POSIX
+// only, other platforms get spike dumps alone.
+namespace FlightRecorder {
+
+// Sets the frame budget in milliseconds, 0 only dumps on crashes, installs the crash handlers and
+// starts the dump thread
+void init(float spikeBudgetMs);
+// Restores the previous crash handlers and stops the dump thread
+void shutdown();
+
+// Closes the current frame and starts the next, called by App at the start of every frame.
+// Dumps the window when the closed frame exceeded the budget.
+void beginFrame();
+// A value of the current frame, the last one per name wins. Main thread only, the name must be a
+// string literal.
+void counter(const char* name, double value);
+// Thread safe, without locks
+void log(const char* line);
+
+// Writes the recorded frames, profiler scopes, counters and log lines as a Chrome trace, on the
+// calling thread. Main thread only.
+bool dump(const char* path, const char* reason);
+
+}  // namespace FlightRecorder
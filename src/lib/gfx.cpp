@@ -5,26 +5,69 @@ void setDrawColor(SDL_Renderer* renderer, const Color& color) {
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 }
 
-void setTextureDrawColor(SDL_Texture* texture, const Color& color) {
-    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
-    SDL_SetTextureAlphaMod(texture, color.a);
-}
-
 SDL_FColor toFColor(const Color& color) {
     return {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
 };
 
 }  // namespace
 
+SDL_BlendMode premultipliedBlendMode() {
+    static const SDL_BlendMode mode = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    return mode;
+}
+
 void RenderContext::clear(Color color) {
+    flush();
     setDrawColor(m_renderer, color);
     SDL_RenderClear(m_renderer);
     setDrawColor(m_renderer, m_currentColor);
 }
 
 void RenderContext::present() {
+    flush();
     m_frameCount++;
     SDL_RenderPresent(m_renderer);
+    endFrameStats();
+}
+
+void RenderContext::endFrameStats() {
+    m_statsHistory[m_statsHistoryHead] = m_stats;
+    m_statsHistoryHead = (m_statsHistoryHead + 1) % STATS_HISTORY;
+    m_stats = {};
+    m_stats.transformDepth = static_cast<uint32_t>(m_transformStack.size());
+    m_lastDrawnTexture = nullptr;
+}
+
+void RenderContext::countDraw(SDL_Texture* texture, int vertices, int indices) {
+    m_stats.drawCalls++;
+    m_stats.vertices += vertices;
+    m_stats.indices += indices;
+    if (texture && texture != m_lastDrawnTexture) {
+        m_stats.textureBinds++;
+        m_lastDrawnTexture = texture;
+    }
+}
+
+void RenderContext::setTextureColorMod(const Color& color) {
+    auto& obj = m_textures[m_currentTexture.key.index];
+    if (obj.colorMod == color) {
+        return;
+    }
+    obj.colorMod = color;
+    m_stats.colorModChanges++;
+    SDL_SetTextureColorMod(obj.ptr, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(obj.ptr, color.a);
+}
+
+Color RenderContext::textureColor() const {
+    if (!m_currentTexture.premultiplied) {
+        return m_currentColor;
+    }
+    auto c = m_currentColor;
+    return {static_cast<uint8_t>(c.r * c.a / 255), static_cast<uint8_t>(c.g * c.a / 255),
+            static_cast<uint8_t>(c.b * c.a / 255), c.a};
 }
 
 void RenderContext::setTransform(const Transform& transform) {
@@ -34,6 +77,8 @@ void RenderContext::setTransform(const Transform& transform) {
 void RenderContext::pushTransform(const Transform& transform) {
     m_transformStack.push_back(m_transformStack.back() * transform.getMatrix());
     m_transform = m_transformStack.back();
+    m_stats.transformDepth =
+        glm::max(m_stats.transformDepth, static_cast<uint32_t>(m_transformStack.size()));
 };
 
 void RenderContext::popTransform() {
@@ -49,7 +94,7 @@ void RenderContext::setColor(Color color) {
     m_currentColor = color;
     setDrawColor(m_renderer, m_currentColor);
     if (m_currentTexture) {
-        setTextureDrawColor(m_currentTexture.ptr, m_currentColor);
+        setTextureColorMod(textureColor());
     }
 }
 
@@ -66,13 +111,15 @@ void RenderContext::setTexture(Texture texture) {
     }
     m_currentTexture = obj;
     if (m_currentTexture) {
-        setTextureDrawColor(m_currentTexture.ptr, m_currentColor);
+        setTextureColorMod(textureColor());
     }
 }
 
 void RenderContext::drawRect(Rect rect, bool outline) {
     SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
     auto r = reinterpret_cast<SDL_FRect*>(&rect);
+    flush();
+    countDraw(nullptr, 4, outline ? 0 : 6);
     if (outline) {
         SDL_RenderRects(m_renderer, r, 1);
     } else {
@@ -107,7 +154,7 @@ void RenderContext::drawTexture(const Rect& rect, const Rect& uvRect, const Mat3
     auto c2 = m * glm::vec3(rect.left(), rect.bottom(), 1);
     auto c3 = m * glm::vec3(rect.right(), rect.bottom(), 1);
 
-    auto c = toFColor(m_currentColor);
+    auto c = toFColor(textureColor());
     vertices[0].position = {c0.x, c0.y};
     vertices[0].tex_coord = {t.left(), t.top()};
     vertices[0].color = c;
@@ -121,17 +168,187 @@ void RenderContext::drawTexture(const Rect& rect, const Rect& uvRect, const Mat3
     vertices[3].tex_coord = {t.right(), t.bottom()};
     vertices[3].color = c;
 
+    flush();
+    countDraw(m_currentTexture.ptr, 4, 6);
     SDL_RenderGeometry(m_renderer, m_currentTexture.ptr, &vertices[0], 4, &indices[0], 6);
 }
 
+void RenderContext::drawGeometry(std::span<const Vertex> vertices, std::span<const int> indices) {
+    const int base = static_cast<int>(m_batchVertices.size());
+    for (const auto& vertex : vertices) {
+        batchVertex(transform(vertex.position), toFColor(vertex.color));
+    }
+    for (int index : indices) {
+        m_batchIndices.push_back(base + index);
+    }
+}
+
+void RenderContext::flush() {
+    if (m_batchIndices.empty()) {
+        m_batchVertices.clear();
+        return;
+    }
+    const auto vertexCount = static_cast<int>(m_batchVertices.size());
+    const auto indexCount = static_cast<int>(m_batchIndices.size());
+    countDraw(nullptr, vertexCount, indexCount);
+    SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(m_renderer, nullptr, m_batchVertices.data(), vertexCount,
+                       m_batchIndices.data(), indexCount);
+    m_batchVertices.clear();
+    m_batchIndices.clear();
+}
+
+int RenderContext::batchVertex(Vec2 position, SDL_FColor color) {
+    m_batchVertices.push_back({{position.x, position.y}, color, {0.0f, 0.0f}});
+    return static_cast<int>(m_batchVertices.size()) - 1;
+}
+
+void RenderContext::batchSegment(Vec2 p0, Vec2 p1, float width, SDL_FColor c0, SDL_FColor c1) {
+    Vec2 direction = p1 - p0;
+    float length = glm::length(direction);
+    direction = length > 0.0f ? direction / length : Vec2(1.0f, 0.0f);
+    Vec2 normal = Vec2(-direction.y, direction.x) * (width * 0.5f);
+
+    int i = batchVertex(p0 + normal, c0);
+    batchVertex(p0 - normal, c0);
+    batchVertex(p1 + normal, c1);
+    batchVertex(p1 - normal, c1);
+    m_batchIndices.insert(m_batchIndices.end(), {i, i + 1, i + 2, i + 2, i + 1, i + 3});
+}
+
+void RenderContext::batchPolyline(float width, bool closed) {
+    // Corners sharper than this ratio of miter length to line width are beveled, as in SVG
+    constexpr float MITER_LIMIT = 4.0f;
+    const auto& points = m_polylinePoints;
+    const int count = static_cast<int>(points.size());
+    closed = closed && count > 2;
+    const float half = width * 0.5f;
+
+    auto direction = [&points, count](int from, Vec2 fallback) {
+        Vec2 d = points[(from + 1) % count] - points[from];
+        float length = glm::length(d);
+        return length > 0.0f ? d / length : fallback;
+    };
+    auto normal = [](Vec2 d) { return Vec2(-d.y, d.x); };
+
+    Vec2 in = direction(closed ? count - 1 : 0, Vec2(1.0f, 0.0f));
+    int firstLeft = 0;
+    int firstRight = 0;
+    int previousLeft = 0;
+    int previousRight = 0;
+    for (int i = 0; i < count; i++) {
+        const Vec2 p = points[i];
+        const SDL_FColor color = m_polylineColors[i];
+        const bool last = i == count - 1;
+        const Vec2 out = last && !closed ? in : direction(i, in);
+        const Vec2 nIn = normal(in);
+        const Vec2 nOut = normal(out);
+        const bool joined = (i > 0 && !last) || closed;
+
+        // Left and right edge where the incoming segment ends and the outgoing one starts
+        int inLeft;
+        int inRight;
+        int outLeft;
+        int outRight;
+        const float cosine = glm::dot(nIn, nOut);
+        if (!joined || 1.0f + cosine >= 2.0f / (MITER_LIMIT * MITER_LIMIT)) {
+            // Miter, the offset grows with the angle to keep the edges at half the width
+            Vec2 miter = joined ? (nIn + nOut) * (half / (1.0f + cosine)) : nOut * half;
+            inLeft = outLeft = batchVertex(p + miter, color);
+            inRight = outRight = batchVertex(p - miter, color);
+        } else {
+            // Bevel, the segments overlap on the inner side and a triangle fills the outer one
+            inLeft = batchVertex(p + nIn * half, color);
+            inRight = batchVertex(p - nIn * half, color);
+            outLeft = batchVertex(p + nOut * half, color);
+            outRight = batchVertex(p - nOut * half, color);
+            const int center = batchVertex(p, color);
+            const bool leftOuter = in.x * out.y - in.y * out.x < 0.0f;
+            if (leftOuter) {
+                m_batchIndices.insert(m_batchIndices.end(), {center, inLeft, outLeft});
+            } else {
+                m_batchIndices.insert(m_batchIndices.end(), {center, inRight, outRight});
+            }
+        }
+
+        if (i == 0) {
+            firstLeft = inLeft;
+            firstRight = inRight;
+        } else {
+            m_batchIndices.insert(m_batchIndices.end(), {previousLeft, previousRight, inLeft,
+                                                         inLeft, previousRight, inRight});
+        }
+        previousLeft = outLeft;
+        previousRight = outRight;
+        in = out;
+    }
+    if (closed) {
+        m_batchIndices.insert(m_batchIndices.end(), {previousLeft, previousRight, firstLeft,
+                                                     firstLeft, previousRight, firstRight});
+    }
+}
+
+void RenderContext::batchQuad(Vec2 center, float size, SDL_FColor color) {
+    float half = size * 0.5f;
+    int i = batchVertex({center.x - half, center.y - half}, color);
+    batchVertex({center.x + half, center.y - half}, color);
+    batchVertex({center.x - half, center.y + half}, color);
+    batchVertex({center.x + half, center.y + half}, color);
+    m_batchIndices.insert(m_batchIndices.end(), {i, i + 1, i + 2, i + 2, i + 1, i + 3});
+}
+
+Rect RenderContext::viewBounds() const {
+    int w = 0;
+    int h = 0;
+    SDL_GetCurrentRenderOutputSize(m_renderer, &w, &h);
+    auto inverse = glm::inverse(m_transform);
+    Vec2 p0 = inverse * Vec3(0.0f, 0.0f, 1.0f);
+    Vec2 p1 = inverse * Vec3(w, h, 1.0f);
+    Vec2 min = glm::min(p0, p1);
+    Vec2 max = glm::max(p0, p1);
+    return {min, max - min};
+}
+
 Vec2 RenderContext::transform(Vec2 v) {
     return m_transform * Vec3(v, 1.0);
 }
 
 void RenderContext::debug(Debugger& debugger) {
     if (debugger.pushSection("RENDERER")) {
-        for (auto& texture : m_textures) {
-            debugger.texture(texture.ptr);
+        const auto& stats = lastFrameStats();
+        debugger.label("draw calls", "%u", stats.drawCalls);
+        debugger.label("vertices / indices", "%u / %u", stats.vertices, stats.indices);
+        debugger.label("texture binds", "%u", stats.textureBinds);
+        debugger.label("color mod changes", "%u", stats.colorModChanges);
+        debugger.label("transform depth", "%u", stats.transformDepth);
+
+        std::array<float, STATS_HISTORY> history;
+        for (int i = 0; i < STATS_HISTORY; i++) {
+            history[i] = static_cast<float>(m_statsHistory[i].drawCalls);
+        }
+        debugger.plot("draw calls", history, m_statsHistoryHead);
+        for (int i = 0; i < STATS_HISTORY; i++) {
+            history[i] = static_cast<float>(m_statsHistory[i].vertices);
+        }
+        debugger.plot("vertices", history, m_statsHistoryHead);
+
+        debugger.label("textures", "%zu", m_textures.size());
+        const int selected = debugger.list(
+            "textures", static_cast<int>(m_textures.size()),
+            [this](int index, Debugger::ListRow& row) {
+                const auto& texture = m_textures[index];
+                if (!texture) {
+                    SDL_snprintf(row.text, sizeof(row.text), "%d  free", index);
+                    return;
+                }
+                SDL_snprintf(row.text, sizeof(row.text), "%d  %dx%d%s", index, texture.bounds.w,
+                             texture.bounds.h, texture.premultiplied ? "  premultiplied" : "");
+                row.texture = texture.ptr;
+                row.textureVersion = texture.key.check;
+                row.textureSize = Size(texture.bounds.w, texture.bounds.h);
+            });
+        if (selected >= 0 && m_textures[selected]) {
+            debugger.texture(m_textures[selected].ptr);
         }
 
         debugger.popSection();
@@ -154,58 +371,105 @@ void RenderContext::drawTexture(SDL_FRect* src,
     }
 
     SDL_FPoint center{0, 0};
+    flush();
+    countDraw(m_currentTexture.ptr, 4, 6);
     SDL_RenderTextureRotated(m_renderer, m_currentTexture.ptr, src, dst, angleDegree, &center,
                              flip);
 }
 
 void RenderContext::drawPoint(Vec2 point, float size) {
-    Vec2 tp = transform(point) / size - 0.5f;
-    auto p = reinterpret_cast<SDL_FPoint*>(&tp);
+    batchQuad(transform(point), size, toFColor(m_currentColor));
+}
 
-    if (size != 1.0f) {
-        SDL_SetRenderScale(m_renderer, size, size);
-        SDL_RenderPoints(m_renderer, p, 1);
-        SDL_SetRenderScale(m_renderer, 1.0f, 1.0f);
-    } else {
-        SDL_RenderPoints(m_renderer, p, 1);
+void RenderContext::drawPoints(std::span<const Vec2> points, float size) {
+    const auto color = toFColor(m_currentColor);
+    for (const auto& point : points) {
+        batchQuad(transform(point), size, color);
     }
 }
 
-void RenderContext::drawLine(Vec2 p0, Vec2 p1, float size) {
-    Vec2 tp0 = transform(p0) / size - 0.5f;
-    Vec2 tp1 = transform(p1) / size - 0.5f;
+void RenderContext::drawLine(Vec2 p0, Vec2 p1, float width) {
+    const auto color = toFColor(m_currentColor);
+    batchSegment(transform(p0), transform(p1), width, color, color);
+}
 
-    if (size != 1.0f) {
-        SDL_SetRenderScale(m_renderer, size, size);
-        SDL_RenderLine(m_renderer, tp0.x, tp0.y, tp1.x, tp1.y);
-        SDL_SetRenderScale(m_renderer, 1.0f, 1.0f);
-    } else {
-        SDL_RenderLine(m_renderer, tp0.x, tp0.y, tp1.x, tp1.y);
+void RenderContext::drawPolyline(std::span<const Vec2> points, float width, bool closed) {
+    if (points.size() < 2) {
+        return;
     }
+    const auto color = toFColor(m_currentColor);
+    m_polylinePoints.clear();
+    m_polylineColors.clear();
+    for (const auto& point : points) {
+        m_polylinePoints.push_back(transform(point));
+        m_polylineColors.push_back(color);
+    }
+    batchPolyline(width, closed);
 }
 
-void RenderContext::drawPolygon(int vertexCount,
-                                bool outline,
-                                std::function<void(Vertex&, int)> callback) {
-    // TODO: this should work with an arbitrary number of vertices
-    SDL_assert(vertexCount == 4);
+void RenderContext::drawPolyline(std::span<const Vertex> vertices, float width, bool closed) {
+    if (vertices.size() < 2) {
+        return;
+    }
+    m_polylinePoints.clear();
+    m_polylineColors.clear();
+    for (const auto& vertex : vertices) {
+        m_polylinePoints.push_back(transform(vertex.position));
+        m_polylineColors.push_back(toFColor(vertex.color));
+    }
+    batchPolyline(width, closed);
+}
 
-    const int indices[6] = {0, 1, 2, 2, 3, 0};
-    std::vector<SDL_Vertex> vertices;
-    vertices.resize(vertexCount);
+void RenderContext::drawPolygon(std::span<const Vertex> vertices, bool outline, float width) {
+    if (outline) {
+        drawPolyline(vertices, width, true);
+        return;
+    }
+    if (vertices.size() < 3) {
+        return;
+    }
+    // Triangle fan, the polygon must be convex
+    const int base = static_cast<int>(m_batchVertices.size());
+    for (const auto& vertex : vertices) {
+        batchVertex(transform(vertex.position), toFColor(vertex.color));
+    }
+    for (int i = 1; i + 1 < static_cast<int>(vertices.size()); i++) {
+        m_batchIndices.insert(m_batchIndices.end(), {base, base + i, base + i + 1});
+    }
+}
 
-    Vertex vertex;
-    for (int i = 0; i < vertexCount; i++) {
-        vertex = {};
-        callback(vertex, i);
-        vertex.position = transform(vertex.position);
+void RenderContext::drawCircle(Vec2 center, float radius, bool outline, float width) {
+    // Enough segments to look round at the circle's size on screen
+    Vec2 screenCenter = transform(center);
+    float screenRadius = glm::length(transform(center + Vec2(radius, 0.0f)) - screenCenter);
+    const int segments = std::clamp(static_cast<int>(screenRadius * 0.5f) + 8, 8, 64);
 
-        vertices[i].position.x = vertex.position.x;
-        vertices[i].position.y = vertex.position.y;
-        vertices[i].color = toFColor(vertex.color);
+    const auto color = toFColor(m_currentColor);
+    const float step = 2.0f * std::numbers::pi_v<float> / segments;
+    const float c = std::cos(step);
+    const float s = std::sin(step);
+    Vec2 offset(radius, 0.0f);
+
+    if (outline) {
+        Vec2 previous = transform(center + offset);
+        for (int i = 0; i < segments; i++) {
+            offset = {offset.x * c - offset.y * s, offset.x * s + offset.y * c};
+            Vec2 current = transform(center + offset);
+            batchSegment(previous, current, width, color, color);
+            previous = current;
+        }
+        return;
     }
 
-    SDL_RenderGeometry(m_renderer, m_currentTexture.ptr, &vertices[0], 4, &indices[0], 6);
+    const int base = batchVertex(screenCenter, color);
+    for (int i = 0; i < segments; i++) {
+        batchVertex(transform(center + offset), color);
+        offset = {offset.x * c - offset.y * s, offset.x * s + offset.y * c};
+    }
+    for (int i = 0; i < segments; i++) {
+        int next = (i + 1) % segments;
+        m_batchIndices.insert(m_batchIndices.end(), {base, base + 1 + i, base + 1 + next});
+    }
 }
 
 Texture RenderContext::createTexture(ImageInfo info, PixelRef pixels, TextureOptions options) {
@@ -217,12 +481,22 @@ Texture RenderContext::createTexture(ImageInfo info, PixelRef pixels, TextureOpt
 
     SDL_Rect rect = {0, 0, info.width, info.height};
     SDL_UpdateTexture(texture, &rect, std::data(pixels.data), pixels.stride);
+    return addTexture(texture, info, options);
+}
 
-    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+Texture RenderContext::addTexture(SDL_Texture* texture, ImageInfo info, TextureOptions options) {
+    SDL_Rect rect = {0, 0, info.width, info.height};
 
     SDL_SetTextureScaleMode(texture, options.scaleMode);
-    SDL_SetTextureBlendMode(texture, options.blendMode);
+    auto blendMode = options.blendMode;
+    if (info.premultiplied && blendMode == SDL_BLENDMODE_BLEND) {
+        blendMode = premultipliedBlendMode();
+    }
+    if (SDL_SetTextureBlendMode(texture, blendMode) != 0) {
+        // e.g. the software renderer has no custom blend modes, premultiplied pixels then only
+        // differ at translucent edges
+        SDL_SetTextureBlendMode(texture, options.blendMode);
+    }
 
     TextureObject* obj = nullptr;
     {
@@ -234,13 +508,16 @@ Texture RenderContext::createTexture(ImageInfo info, PixelRef pixels, TextureOpt
             Texture::Id key = {0, 0};
             key.index = static_cast<uint16_t>(m_textures.size());
 
-            m_textures.push_back({key, nullptr, {0, 0, 0, 0}});
+            m_textures.push_back({key, nullptr, {0, 0, 0, 0}, false, Colors::WHITE});
             obj = &m_textures.back();
         }
     }
     obj->key.check += 1;
     obj->ptr = texture;
     obj->bounds = rect;
+    obj->premultiplied = info.premultiplied;
+    // The mod SDL creates textures with
+    obj->colorMod = Colors::WHITE;
 
     Texture tex = {obj->key, rect.w, rect.h};
     return tex;
@@ -2,6 +2,7 @@
 
 #include <SDL3/SDL.h>
 
+#include <array>
 #include <memory>
 #include <span>
 #include <vector>
@@ -16,6 +17,8 @@ struct ImageInfo {
     int width;
     int height;
     PixelFormat format = PixelFormat::RGBA;
+    // Color channels already multiplied by alpha, textures created from it blend accordingly
+    bool premultiplied = false;
 };
 
 struct PixelRef {
@@ -23,6 +26,12 @@ struct PixelRef {
     int stride;
 };
 
+// Writable pixels, e.g. a decode target
+struct PixelBuffer {
+    std::span<uint8_t> data;
+    int stride;
+};
+
 struct Image {
     ImageInfo info;
     PixelRef pixels;
@@ -55,11 +64,25 @@ struct TextureOptions {
     SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
 };
 
+// Source over for pixels whose color is already multiplied by alpha, not supported by every
+// renderer
+SDL_BlendMode premultipliedBlendMode();
+
 struct Vertex {
     Vec2 position;
     Color color;
 };
 
+// Work submitted to SDL during one frame
+struct RenderStats {
+    uint32_t drawCalls = 0;
+    uint32_t vertices = 0;
+    uint32_t indices = 0;
+    uint32_t textureBinds = 0;
+    uint32_t colorModChanges = 0;
+    uint32_t transformDepth = 0;
+};
+
 class RenderContext {
   public:
     RenderContext(SDL_Renderer* renderer) : m_renderer(renderer){};
@@ -68,9 +91,11 @@ class RenderContext {
     void present();
 
     void setTransform(const Transform& transform);
-    // const Transform& getTransform() const {
-    //     return m_transform;
-    // }
+    const Mat3& getTransform() const {
+        return m_transform;
+    }
+    // The part of the output visible under the current transform, in its coordinates
+    Rect viewBounds() const;
     void pushTransform(const Transform& transform);
     void popTransform();
 
@@ -90,10 +115,21 @@ class RenderContext {
 
     void drawTexture(const Rect& rect, const Rect& textureRect, const Mat3& matrix);
 
+    // Untextured primitives are built as triangles into a shared batch with per-vertex colors,
+    // which is submitted with a single draw call when something else is drawn or on flush().
+    // Positions are in the current transform, line widths and point sizes in pixels.
     void drawPoint(Vec2 point, float size = 1.0f);
-    void drawLine(Vec2 p0, Vec2 p1, float size = 1.0f);
-
-    void drawPolygon(int vertexCount, bool outline, std::function<void(Vertex&, int)> callback);
+    void drawPoints(std::span<const Vec2> points, float size = 1.0f);
+    void drawLine(Vec2 p0, Vec2 p1, float width = 1.0f);
+    void drawPolyline(std::span<const Vec2> points, float width = 1.0f, bool closed = false);
+    void drawPolyline(std::span<const Vertex> vertices, float width = 1.0f, bool closed = false);
+    // Convex polygon with any number of vertices
+    void drawPolygon(std::span<const Vertex> vertices, bool outline = false, float width = 1.0f);
+    void drawCircle(Vec2 center, float radius, bool outline = false, float width = 1.0f);
+    // Triangles given by indices into vertices
+    void drawGeometry(std::span<const Vertex> vertices, std::span<const int> indices);
+    // Submits the batched primitives
+    void flush();
 
     Texture createTexture(ImageInfo info,
                           PixelRef pixels,
@@ -104,6 +140,16 @@ class RenderContext {
         return m_frameCount;
     }
 
+    // Stats of the frame being drawn, and of the last presented frame
+    const RenderStats& currentStats() const {
+        return m_stats;
+    }
+    const RenderStats& lastFrameStats() const {
+        return m_statsHistory[(m_statsHistoryHead + STATS_HISTORY - 1) % STATS_HISTORY];
+    }
+    // Closes the stats of the current frame, called by present()
+    void endFrameStats();
+
     [[deprecated]]
     SDL_Renderer* getRenderer() {
         return m_renderer;
@@ -117,14 +163,31 @@ class RenderContext {
     void debug(Debugger& debugger);
 
   private:
+    static constexpr int STATS_HISTORY = 120;
+
     Vec2 transform(Vec2 v);
+    void countDraw(SDL_Texture* texture, int vertices, int indices);
+    // Applies the color and alpha mod to the current texture, unless it already has them
+    void setTextureColorMod(const Color& color);
+    // The current color as applied to the current texture, premultiplied if its pixels are
+    Color textureColor() const;
+    // Batch helpers, positions in output pixels
+    int batchVertex(Vec2 position, SDL_FColor color);
+    void batchSegment(Vec2 p0, Vec2 p1, float width, SDL_FColor c0, SDL_FColor c1);
+    // Joined segments through m_polylinePoints and m_polylineColors
+    void batchPolyline(float width, bool closed);
+    void batchQuad(Vec2 center, float size, SDL_FColor color);
     void drawTexture(SDL_FRect* src, SDL_FRect* dst, float angleDegree, bool flipX, bool flipY);
+    Texture addTexture(SDL_Texture* texture, ImageInfo info, TextureOptions options);
 
     class TextureObject {
       public:
         Texture::Id key;
         SDL_Texture* ptr;
         SDL_Rect bounds;
+        bool premultiplied;
+        // Last color and alpha mod set on ptr
+        Color colorMod;
 
         operator bool() const {
             return ptr != nullptr;
@@ -136,7 +199,16 @@ class RenderContext {
     TextureObject m_currentTexture{};
 
     std::vector<TextureObject> m_textures;
-    uint64_t m_frameCount;
+    uint64_t m_frameCount = 0;
+    std::vector<SDL_Vertex> m_batchVertices;
+    std::vector<int> m_batchIndices;
+    std::vector<Vec2> m_polylinePoints;
+    std::vector<SDL_FColor> m_polylineColors;
+
+    RenderStats m_stats;
+    SDL_Texture* m_lastDrawnTexture = nullptr;
+    std::array<RenderStats, STATS_HISTORY> m_statsHistory{};
+    int m_statsHistoryHead = 0;
 
     Mat3 m_transform;
     std::vector<Mat3> m_transformStack = {Mat3(1.0)};
@@ -0,0 +1,319 @@
+#include "image_cache.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "png.hpp"
+
+namespace {
+
+// Bump when the decoded output changes, older files are then rebuilt
+constexpr uint32_t VERSION = 1;
+constexpr uint64_t ALIGNMENT = 16;
+constexpr uint32_t MAX_SIZE = 16384;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t tocOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(Header) == 32);
+
+struct Entry {
+    uint64_t hash;
+    uint32_t encodedSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    uint64_t offset;
+};
+static_assert(sizeof(Entry) == 32);
+
+struct Decoded {
+    uint64_t hash;
+    uint32_t encodedSize;
+    ImageInfo info;
+    std::vector<uint8_t> pixels;
+};
+
+// Everything is guarded by s_mutex, decoding happens outside of it
+std::mutex s_mutex;
+bool s_open = false;
+std::string s_path;
+MappedFile s_file;
+const Entry* s_entries = nullptr;
+uint32_t s_entryCount = 0;
+std::vector<bool> s_used;
+// Decoded this run, the pixel buffers don't move when the vector grows
+std::vector<Decoded> s_decoded;
+uint64_t s_hits = 0;
+uint64_t s_misses = 0;
+
+uint64_t hashContent(std::span<const uint8_t> data) {
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : data) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool before(uint64_t hash, uint32_t size, uint64_t otherHash, uint32_t otherSize) {
+    return hash < otherHash || (hash == otherHash && size < otherSize);
+}
+
+const Entry* findMapped(uint64_t hash, uint32_t size) {
+    auto end = s_entries + s_entryCount;
+    auto it = std::lower_bound(s_entries, end, hash, [&](const Entry& e, uint64_t) {
+        return before(e.hash, e.encodedSize, hash, size);
+    });
+    return it != end && it->hash == hash && it->encodedSize == size ? it : nullptr;
+}
+
+// Maps the file and checks every entry, an invalid file is ignored and replaced on close
+bool map(const char* path) {
+    if (!s_file.open(path)) {
+        return false;
+    }
+    auto data = s_file.data();
+    Header header{};
+    bool valid = data.size() >= sizeof(Header);
+    if (valid) {
+        std::memcpy(&header, data.data(), sizeof(Header));
+        valid = std::memcmp(header.magic, "Q14I", 4) == 0 && header.version == VERSION &&
+                header.fileSize == data.size() && header.tocOffset % alignof(Entry) == 0 &&
+                header.tocOffset + uint64_t(header.entryCount) * sizeof(Entry) <= data.size();
+    }
+    auto entries = valid ? reinterpret_cast<const Entry*>(&data[header.tocOffset]) : nullptr;
+    for (uint32_t i = 0; valid && i < header.entryCount; i++) {
+        const auto& e = entries[i];
+        valid = e.width > 0 && e.height > 0 && e.width <= MAX_SIZE && e.height <= MAX_SIZE &&
+                e.offset + uint64_t(e.width) * e.height * 4 <= data.size() &&
+                (i == 0 || before(entries[i - 1].hash, entries[i - 1].encodedSize, e.hash,
+                                  e.encodedSize));
+    }
+    if (!valid) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "ImageCache: ignoring outdated %s", path);
+        s_file.close();
+        return false;
+    }
+    s_entries = entries;
+    s_entryCount = header.entryCount;
+    return true;
+}
+
+void premultiply(std::span<uint8_t> pixels) {
+    for (size_t i = 0; i + 4 <= pixels.size(); i += 4) {
+        const uint32_t a = pixels[i + 3];
+        if (a == 255) {
+            continue;
+        }
+        // Rounded division by 255
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = pixels[i + c] * a + 128;
+            pixels[i + c] = static_cast<uint8_t>((v + (v >> 8)) >> 8);
+        }
+    }
+}
+
+void setImage(Image& image, ImageInfo info, const uint8_t* pixels) {
+    image.info = info;
+    image.info.premultiplied = true;
+    image.pixels = {{pixels, static_cast<size_t>(info.width) * info.height * 4}, info.width * 4};
+    image.data = {nullptr, nullptr};
+}
+
+// Writes the decoded entries and the mapped ones used in this run to a temporary file, then
+// replaces the cache file with it
+bool write() {
+    struct Item {
+        Entry entry;
+        const uint8_t* pixels;
+    };
+    std::vector<Item> items;
+    for (uint32_t i = 0; i < s_entryCount; i++) {
+        if (s_used[i]) {
+            items.push_back({s_entries[i], &s_file.data()[s_entries[i].offset]});
+        }
+    }
+    for (const auto& d : s_decoded) {
+        Entry entry = {d.hash,
+                       d.encodedSize,
+                       static_cast<uint32_t>(d.info.width),
+                       static_cast<uint32_t>(d.info.height),
+                       0,
+                       0};
+        items.push_back({entry, d.pixels.data()});
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return before(a.entry.hash, a.entry.encodedSize, b.entry.hash, b.entry.encodedSize);
+    });
+    // The same image decoded by two threads at once
+    items.erase(std::unique(items.begin(), items.end(),
+                            [](const Item& a, const Item& b) {
+                                return a.entry.hash == b.entry.hash &&
+                                       a.entry.encodedSize == b.entry.encodedSize;
+                            }),
+                items.end());
+
+    auto align = [](uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; };
+    Header header = {{'Q', '1', '4', 'I'}, VERSION, static_cast<uint32_t>(items.size()), 0,
+                     sizeof(Header), 0};
+    uint64_t offset = align(sizeof(Header) + items.size() * sizeof(Entry));
+    for (auto& item : items) {
+        item.entry.offset = offset;
+        offset = align(offset + uint64_t(item.entry.width) * item.entry.height * 4);
+    }
+    header.fileSize = offset;
+
+    const std::string temp = s_path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ImageCache: failed to create %s",
+                     temp.c_str());
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const auto& item : items) {
+        ok = ok && std::fwrite(&item.entry, sizeof(Entry), 1, file) == 1;
+    }
+    const uint8_t padding[ALIGNMENT] = {};
+    for (const auto& item : items) {
+        auto size = size_t(item.entry.width) * item.entry.height * 4;
+        auto position = static_cast<uint64_t>(std::ftell(file));
+        ok = ok && std::fwrite(padding, 1, item.entry.offset - position, file) ==
+                       item.entry.offset - position;
+        ok = ok && std::fwrite(item.pixels, 1, size, file) == size;
+    }
+    auto position = static_cast<uint64_t>(std::ftell(file));
+    ok = ok && std::fwrite(padding, 1, header.fileSize - position, file) ==
+                   header.fileSize - position;
+    ok = std::fclose(file) == 0 && ok;
+
+    // The mapping has to go before the file can be replaced on Windows
+    s_file.close();
+    s_entries = nullptr;
+    s_entryCount = 0;
+    if (ok && std::rename(temp.c_str(), s_path.c_str()) != 0) {
+        std::remove(s_path.c_str());
+        ok = std::rename(temp.c_str(), s_path.c_str()) == 0;
+    }
+    if (!ok) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ImageCache: failed to write %s",
+                     s_path.c_str());
+        std::remove(temp.c_str());
+        return false;
+    }
+    SDL_Log("ImageCache: wrote %s, %zu images, %llu bytes", s_path.c_str(), items.size(),
+            static_cast<unsigned long long>(header.fileSize));
+    return true;
+}
+
+}  // namespace
+
+void ImageCache::open(const char* path) {
+    close();
+    std::lock_guard lock(s_mutex);
+    s_path = path;
+    s_open = true;
+    s_hits = 0;
+    s_misses = 0;
+    if (map(path)) {
+        SDL_Log("ImageCache: %s, %u images%s", path, s_entryCount,
+                s_file.mapped() ? ", mapped" : "");
+    }
+    s_used.assign(s_entryCount, false);
+}
+
+void ImageCache::flush() {
+    std::lock_guard lock(s_mutex);
+    if (!s_open || s_decoded.empty()) {
+        return;
+    }
+    write();
+    s_decoded.clear();
+    s_decoded.shrink_to_fit();
+    // Every image in the new file was used in this run
+    map(s_path.c_str());
+    s_used.assign(s_entryCount, true);
+}
+
+void ImageCache::close() {
+    std::lock_guard lock(s_mutex);
+    if (!s_open) {
+        return;
+    }
+    if (!s_decoded.empty()) {
+        write();
+    }
+    s_file.close();
+    s_entries = nullptr;
+    s_entryCount = 0;
+    s_used.clear();
+    s_decoded.clear();
+    s_decoded.shrink_to_fit();
+    s_open = false;
+}
+
+bool ImageCache::isOpen() {
+    std::lock_guard lock(s_mutex);
+    return s_open;
+}
+
+bool ImageCache::load(std::span<const uint8_t> encoded, Image& image) {
+    const uint64_t hash = hashContent(encoded);
+    const auto size = static_cast<uint32_t>(encoded.size());
+    {
+        std::lock_guard lock(s_mutex);
+        if (auto e = findMapped(hash, size)) {
+            s_used[e - s_entries] = true;
+            s_hits++;
+            ImageInfo info{static_cast<int>(e->width), static_cast<int>(e->height)};
+            setImage(image, info, &s_file.data()[e->offset]);
+            return true;
+        }
+        for (const auto& d : s_decoded) {
+            if (d.hash == hash && d.encodedSize == size) {
+                s_hits++;
+                setImage(image, d.info, d.pixels.data());
+                return true;
+            }
+        }
+    }
+
+    Decoded decoded{hash, size, {}, {}};
+    if (!Png::readInfo(encoded, decoded.info)) {
+        return false;
+    }
+    decoded.pixels.resize(static_cast<size_t>(decoded.info.width) * decoded.info.height * 4);
+    if (!Png::decode(encoded, {decoded.pixels, decoded.info.width * 4})) {
+        return false;
+    }
+    premultiply(decoded.pixels);
+
+    std::lock_guard lock(s_mutex);
+    if (!s_open) {
+        SDL_SetError("ImageCache: closed");
+        return false;
+    }
+    s_misses++;
+    setImage(image, decoded.info, decoded.pixels.data());
+    s_decoded.push_back(std::move(decoded));
+    return true;
+}
+
+ImageCache::Stats ImageCache::stats() {
+    std::lock_guard lock(s_mutex);
+    return {s_hits, s_misses, static_cast<int>(s_entryCount), static_cast<int>(s_decoded.size())};
+}
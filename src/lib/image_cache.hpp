@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "gfx.hpp"
+
+// Decoded images kept on disk between runs, so a launch with unchanged assets maps the pixels
+// instead of decoding them again.
+//
+// Images are keyed by a hash of their encoded data and stored as premultiplied RGBA, ready for
+// upload. The file is memory mapped when the cache is opened. Images decoded during the run are
+// kept in memory until flush() or close() rewrite the file with them and the mapped images used
+// in this run, so images of changed assets drop out.
+//
+// All integers are little endian. The file starts with a 32 byte header:
+//   char magic[4] "Q14I", uint32 version, uint32 entryCount, uint32 reserved,
+//   uint64 tocOffset, uint64 fileSize
+// followed by entryCount 32 byte entries sorted by hash, then encoded size:
+//   uint64 hash, uint32 encodedSize, uint32 width, uint32 height, uint32 reserved, uint64 offset
+// Pixel data starts on 16 byte boundaries, rows are width * 4 bytes.
+namespace ImageCache {
+
+struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    // Images in the mapped file and decoded since open()
+    int mapped;
+    int decoded;
+};
+
+// Maps the cache file at path, a missing or outdated file starts an empty cache
+void open(const char* path);
+// Writes the file if images were decoded, frees their pixels and maps the new file. Images from
+// load() are invalid afterwards, so only call it when none wait for upload, e.g. after the
+// initial batch of textures.
+void flush();
+// Writes the file if images were decoded and releases the pixels, images from load() are invalid
+// afterwards
+void close();
+bool isOpen();
+
+// Premultiplied pixels of the encoded PNG, from the file or decoded now. The pixels are owned by
+// the cache and stay valid until flush() or close(). Safe to call from several threads. False
+// when the image can't be decoded, see SDL_GetError.
+bool load(std::span<const uint8_t> encoded, Image& image);
+
+Stats stats();
+
+}  // namespace ImageCache
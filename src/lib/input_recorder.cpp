@@ -0,0 +1,217 @@
+#include "input_recorder.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include <SDL3/SDL.h>
+
+namespace {
+
+constexpr char MAGIC[4] = {'Q', '1', '4', 'I'};
+constexpr size_t FLUSH_SIZE = 4096;
+
+constexpr AnalogInputValue InputState::*FIELDS[] = {
+    &InputState::up,   &InputState::down,          &InputState::left,
+    &InputState::right, &InputState::primaryAction, &InputState::secondaryAction,
+};
+constexpr int FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+static_assert(FIELD_COUNT <= 8, "field mask must fit in a byte");
+
+uint32_t encodeValue(float value) {
+    return std::rotl(std::bit_cast<uint32_t>(value), 9);
+}
+
+float decodeValue(uint32_t value) {
+    return std::bit_cast<float>(std::rotr(value, 9));
+}
+
+bool sameBits(float a, float b) {
+    return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+}
+
+}  // namespace
+
+InputRecorder::~InputRecorder() {
+    close();
+}
+
+bool InputRecorder::open(const char* path, uint64_t seed, uint64_t startTicks) {
+    close();
+    m_file = std::fopen(path, "wb");
+    if (!m_file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputRecorder: could not open %s", path);
+        return false;
+    }
+
+    m_previous = {};
+    m_repeat = 0;
+    m_tickCount = 0;
+    m_buffer.clear();
+    m_buffer.insert(m_buffer.end(), std::begin(MAGIC), std::end(MAGIC));
+    m_buffer.push_back(InputRecording::VERSION);
+    writeVarint(seed);
+    writeVarint(startTicks);
+    return true;
+}
+
+void InputRecorder::record(const InputState& state) {
+    if (!m_file) {
+        return;
+    }
+    m_tickCount++;
+
+    uint8_t mask = 0;
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (!sameBits((state.*FIELDS[i]).value, (m_previous.*FIELDS[i]).value)) {
+            mask |= 1 << i;
+        }
+    }
+
+    if (mask == 0) {
+        m_repeat++;
+        return;
+    }
+
+    writeVarint(m_repeat);
+    m_buffer.push_back(mask);
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            writeVarint(encodeValue((state.*FIELDS[i]).value));
+        }
+    }
+    m_previous = state;
+    m_repeat = 0;
+
+    if (m_buffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+}
+
+void InputRecorder::close() {
+    if (!m_file) {
+        return;
+    }
+    writeVarint(m_repeat);
+    m_buffer.push_back(0);
+    flush();
+    std::fclose(m_file);
+    m_file = nullptr;
+    SDL_Log("InputRecorder: recorded %llu ticks", static_cast<unsigned long long>(m_tickCount));
+}
+
+void InputRecorder::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        m_buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    m_buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void InputRecorder::flush() {
+    if (!m_buffer.empty()) {
+        std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+        m_buffer.clear();
+    }
+}
+
+bool InputReplayer::open(const char* path) {
+    close();
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputReplayer: could not open %s", path);
+        return false;
+    }
+
+    uint8_t chunk[FLUSH_SIZE];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        m_data.insert(m_data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+
+    if (m_data.size() < sizeof(MAGIC) + 1 || std::memcmp(m_data.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+        m_data[sizeof(MAGIC)] != InputRecording::VERSION) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputReplayer: %s is not a recording", path);
+        close();
+        return false;
+    }
+
+    m_offset = sizeof(MAGIC) + 1;
+    if (!readVarint(m_seed) || !readVarint(m_startTicks)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputReplayer: %s is truncated", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool InputReplayer::next(InputState& state) {
+    while (m_repeat == 0 && !m_pendingChange) {
+        if (m_ended || !readRecord()) {
+            m_ended = true;
+            return false;
+        }
+    }
+
+    if (m_repeat > 0) {
+        m_repeat--;
+    } else {
+        m_state = m_next;
+        m_pendingChange = false;
+    }
+
+    m_tickCount++;
+    state = m_state;
+    return true;
+}
+
+void InputReplayer::close() {
+    m_data.clear();
+    m_offset = 0;
+    m_state = {};
+    m_next = {};
+    m_repeat = 0;
+    m_pendingChange = false;
+    m_ended = false;
+    m_tickCount = 0;
+}
+
+bool InputReplayer::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && m_offset < m_data.size(); shift += 7) {
+        uint8_t byte = m_data[m_offset++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputReplayer::readRecord() {
+    uint64_t repeat;
+    if (!readVarint(repeat) || m_offset >= m_data.size()) {
+        return false;
+    }
+
+    uint8_t mask = m_data[m_offset++];
+    m_repeat = repeat;
+    if (mask == 0) {
+        // End of recording, but the last state may still repeat
+        m_ended = true;
+        return repeat > 0;
+    }
+
+    m_next = m_state;
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            uint64_t value;
+            if (!readVarint(value)) {
+                return false;
+            }
+            (m_next.*FIELDS[i]).value = decodeValue(static_cast<uint32_t>(value));
+        }
+    }
+    m_pendingChange = true;
+    return true;
+}
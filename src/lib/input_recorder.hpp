@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "input.hpp"
+
+// Input recordings store one InputState per update tick.
+//
+// The file starts with a header: the magic "Q14I", a format version byte, and the random seed and
+// start ticks of the session as varints. It is followed by records of the form
+//   varint repeat, uint8 mask, varint value for every bit set in mask
+// meaning "the previous state repeats for `repeat` ticks, then the fields in `mask` change".
+// Values are the float bits rotated so sign and exponent come first, which keeps the common 0 and
+// +-1 values to one or two bytes. A record with an empty mask ends the recording.
+namespace InputRecording {
+constexpr uint8_t VERSION = 1;
+}
+
+class InputRecorder {
+  public:
+    ~InputRecorder();
+
+    bool open(const char* path, uint64_t seed, uint64_t startTicks);
+    void record(const InputState& state);
+    void close();
+
+    bool active() const {
+        return m_file != nullptr;
+    }
+
+    uint64_t tickCount() const {
+        return m_tickCount;
+    }
+
+  private:
+    void writeVarint(uint64_t value);
+    void flush();
+
+    FILE* m_file = nullptr;
+    std::vector<uint8_t> m_buffer;
+    InputState m_previous;
+    uint64_t m_repeat = 0;
+    uint64_t m_tickCount = 0;
+};
+
+class InputReplayer {
+  public:
+    bool open(const char* path);
+    // Returns false once the recording has ended
+    bool next(InputState& state);
+    void close();
+
+    bool active() const {
+        return !m_data.empty();
+    }
+
+    uint64_t seed() const {
+        return m_seed;
+    }
+
+    uint64_t startTicks() const {
+        return m_startTicks;
+    }
+
+    uint64_t tickCount() const {
+        return m_tickCount;
+    }
+
+  private:
+    bool readVarint(uint64_t& value);
+    bool readRecord();
+
+    std::vector<uint8_t> m_data;
+    size_t m_offset = 0;
+    InputState m_state;
+    InputState m_next;
+    uint64_t m_repeat = 0;
+    bool m_pendingChange = false;
+    bool m_ended = false;
+    uint64_t m_seed = 0;
+    uint64_t m_startTicks = 0;
+    uint64_t m_tickCount = 0;
+};
@@ -0,0 +1,274 @@
+#include "logger.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t MASK = CAPACITY - 1;
+constexpr int LINE_LENGTH = 512;
+
+// Bounded MPMC queue (Vyukov): every cell carries a sequence number telling producers and
+// consumers whose turn it is, so neither side takes a lock
+struct Cell {
+    std::atomic<size_t> sequence;
+    Log::detail::Record record;
+};
+
+struct Ring {
+    Ring() {
+        for (size_t i = 0; i < CAPACITY; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const Log::detail::Record& record) {
+        size_t pos = enqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & MASK];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.record = record;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(Log::detail::Record& record) {
+        size_t pos = dequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & MASK];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    record = cell.record;
+                    cell.sequence.store(pos + CAPACITY, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t size() const {
+        return enqueue.load(std::memory_order_relaxed) - dequeue.load(std::memory_order_relaxed);
+    }
+
+    Cell cells[CAPACITY];
+    alignas(64) std::atomic<size_t> enqueue{0};
+    alignas(64) std::atomic<size_t> dequeue{0};
+};
+
+Ring s_ring;
+std::atomic<uint64_t> s_dropped{0};
+std::atomic<bool> s_running{false};
+SDL_Thread* s_thread = nullptr;
+SDL_Semaphore* s_wake = nullptr;
+
+SDL_LogPriority toPriority(Log::Level level) {
+    switch (level) {
+        case Log::Level::Trace:
+            return SDL_LOG_PRIORITY_VERBOSE;
+        case Log::Level::Debug:
+            return SDL_LOG_PRIORITY_DEBUG;
+        case Log::Level::Info:
+            return SDL_LOG_PRIORITY_INFO;
+        case Log::Level::Warn:
+            return SDL_LOG_PRIORITY_WARN;
+        case Log::Level::Error:
+            return SDL_LOG_PRIORITY_ERROR;
+    }
+    return SDL_LOG_PRIORITY_INFO;
+}
+
+// printf for a record: every conversion is formatted on its own with the length modifier replaced
+// by one matching the stored argument, so a mismatched format can not read garbage
+void format(const Log::detail::Record& record, char* out, size_t size) {
+    using Log::detail::ArgType;
+
+    size_t length = 0;
+    auto append = [&](const char* str, size_t count) {
+        count = SDL_min(count, size - 1 - length);
+        std::memcpy(out + length, str, count);
+        length += count;
+    };
+
+    int index = 0;
+    const char* f = record.format;
+    while (*f && length + 1 < size) {
+        if (*f != '%') {
+            const char* next = std::strchr(f, '%');
+            size_t count = next ? static_cast<size_t>(next - f) : std::strlen(f);
+            append(f, count);
+            f += count;
+            continue;
+        }
+        if (f[1] == '%') {
+            append("%", 1);
+            f += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion, without the length
+        char spec[32] = "%";
+        size_t specLength = 1;
+        f++;
+        while (*f && std::strchr("-+ #0123456789.", *f) && specLength < sizeof(spec) - 4) {
+            spec[specLength++] = *f++;
+        }
+        while (*f && std::strchr("hljztL", *f)) {
+            f++;
+        }
+        char conversion = *f ? *f++ : 's';
+
+        char buffer[128];
+        int written = 0;
+        if (index >= record.argCount) {
+            written = std::snprintf(buffer, sizeof(buffer), "<?>");
+        } else {
+            auto type = record.types[index];
+            auto value = record.values[index];
+            index++;
+            double real = type == ArgType::Double ? std::bit_cast<double>(value)
+                          : type == ArgType::Int  ? static_cast<double>(static_cast<int64_t>(value))
+                                                  : static_cast<double>(value);
+            long long integer = type == ArgType::Double ? static_cast<long long>(real)
+                                                        : static_cast<long long>(value);
+
+            if (std::strchr("di", conversion)) {
+                std::strcpy(spec + specLength, "lld");
+                written = std::snprintf(buffer, sizeof(buffer), spec, integer);
+            } else if (std::strchr("uoxX", conversion)) {
+                const char suffix[] = {'l', 'l', conversion, '\0'};
+                std::strcpy(spec + specLength, suffix);
+                written = std::snprintf(buffer, sizeof(buffer), spec,
+                                        static_cast<unsigned long long>(integer));
+            } else if (conversion == 'c') {
+                std::strcpy(spec + specLength, "c");
+                written = std::snprintf(buffer, sizeof(buffer), spec, static_cast<int>(integer));
+            } else if (std::strchr("fFeEgGaA", conversion)) {
+                const char suffix[] = {conversion, '\0'};
+                std::strcpy(spec + specLength, suffix);
+                written = std::snprintf(buffer, sizeof(buffer), spec, real);
+            } else if (conversion == 'p') {
+                std::strcpy(spec + specLength, "p");
+                written = std::snprintf(buffer, sizeof(buffer), spec,
+                                        reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+            } else if (type == ArgType::String) {
+                std::strcpy(spec + specLength, "s");
+                written = std::snprintf(buffer, sizeof(buffer), spec, record.strings + value);
+            } else {
+                written = std::snprintf(buffer, sizeof(buffer), "<?>");
+            }
+        }
+        if (written > 0) {
+            append(buffer, SDL_min(static_cast<size_t>(written), sizeof(buffer) - 1));
+        }
+    }
+    out[length] = '\0';
+}
+
+void output(const Log::detail::Record& record) {
+    char line[LINE_LENGTH];
+    format(record, line, sizeof(line));
+    SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, toPriority(record.level), "%s", line);
+}
+
+int consumer(void*) {
+    while (s_running.load(std::memory_order_acquire)) {
+        Log::flush();
+        SDL_WaitSemaphoreTimeout(s_wake, 10);
+    }
+    Log::flush();
+    return 0;
+}
+
+}  // namespace
+
+void Log::init() {
+    if (s_running) {
+        return;
+    }
+    // The compile-time level is the filter, let SDL print everything that gets here
+    SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION,
+                       toPriority(static_cast<Level>(SDL_min(Q14_LOG_LEVEL, 4))));
+
+    s_wake = SDL_CreateSemaphore(0);
+    s_running = true;
+    s_thread = SDL_CreateThread(consumer, "q14-log", nullptr);
+    if (!s_thread) {
+        // No threads on this platform, messages are written by the caller
+        s_running = false;
+        SDL_DestroySemaphore(s_wake);
+        s_wake = nullptr;
+    }
+}
+
+void Log::shutdown() {
+    if (!s_running) {
+        flush();
+        return;
+    }
+    s_running = false;
+    SDL_PostSemaphore(s_wake);
+    SDL_WaitThread(s_thread, nullptr);
+    SDL_DestroySemaphore(s_wake);
+    s_thread = nullptr;
+    s_wake = nullptr;
+}
+
+void Log::flush() {
+    detail::Record record;
+    while (s_ring.pop(record)) {
+        output(record);
+    }
+    if (auto dropped = s_dropped.exchange(0)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Log: dropped %llu messages",
+                    static_cast<unsigned long long>(dropped));
+    }
+}
+
+void Log::detail::packString(Record& record, int index, const char* str) {
+    record.types[index] = ArgType::String;
+    record.values[index] = record.stringSize;
+    if (!str) {
+        str = "(null)";
+    }
+    size_t available = STRING_CAPACITY - record.stringSize;
+    size_t length = SDL_min(std::strlen(str), available - 1);
+    std::memcpy(record.strings + record.stringSize, str, length);
+    record.strings[record.stringSize + length] = '\0';
+    record.stringSize = static_cast<uint8_t>(SDL_min(record.stringSize + length + 1,
+                                                     static_cast<size_t>(STRING_CAPACITY - 1)));
+}
+
+void Log::detail::push(const Record& record) {
+    if (!s_running.load(std::memory_order_relaxed)) {
+        output(record);
+        return;
+    }
+    if (!s_ring.push(record)) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Wake the consumer early for messages that should not wait, or before the ring fills up
+    if (record.level >= Level::Warn || s_ring.size() > CAPACITY / 2) {
+        SDL_PostSemaphore(s_wake);
+    }
+}
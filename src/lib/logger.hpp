@@ -0,0 +1,109 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+// Asynchronous logger for hot paths.
+//
+//   Q14_LOG_DEBUG("Jump tick %d", jumpTicks);
+//
+// The call site only copies the format pointer and the arguments into a lock-free ring buffer,
+// formatting and output happen on a background thread which hands the line to SDL_LogMessage, so
+// it reaches the SDL output function (console and debugger). The format must be a string literal,
+// string arguments are copied (up to 64 bytes per message). Levels below Q14_LOG_LEVEL are compiled
+// out. When the ring is full messages are dropped, and the number dropped is reported later.
+namespace Log {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warn, Error };
+
+// Starts the consumer thread. Without it (or without thread support) messages are written
+// synchronously by the caller
+void init();
+// Writes all pending messages and stops the consumer thread
+void shutdown();
+// Writes all pending messages on the calling thread
+void flush();
+
+namespace detail {
+
+constexpr int MAX_ARGS = 8;
+constexpr int STRING_CAPACITY = 64;
+
+enum class ArgType : uint8_t { Int, Uint, Double, Pointer, String };
+
+struct Record {
+    const char* format;
+    Level level;
+    uint8_t argCount;
+    uint8_t stringSize;
+    ArgType types[MAX_ARGS];
+    uint64_t values[MAX_ARGS];
+    char strings[STRING_CAPACITY];
+};
+
+void packString(Record& record, int index, const char* str);
+void push(const Record& record);
+
+template <typename T>
+void pack(Record& record, int index, const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        packString(record, index, value);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        record.types[index] = ArgType::Double;
+        record.values[index] = std::bit_cast<uint64_t>(static_cast<double>(value));
+    } else if constexpr (std::is_enum_v<U>) {
+        pack(record, index, static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        record.types[index] = ArgType::Int;
+        record.values[index] = static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<U>) {
+        record.types[index] = ArgType::Uint;
+        record.values[index] = static_cast<uint64_t>(value);
+    } else if constexpr (std::is_pointer_v<U>) {
+        record.types[index] = ArgType::Pointer;
+        record.values[index] = reinterpret_cast<uintptr_t>(value);
+    } else {
+        static_assert(std::is_pointer_v<U>, "Unsupported log argument type");
+    }
+}
+
+}  // namespace detail
+
+template <typename... Args>
+void write(Level level, const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= detail::MAX_ARGS, "Too many log arguments");
+    detail::Record record;
+    record.format = format;
+    record.level = level;
+    record.argCount = sizeof...(Args);
+    record.stringSize = 0;
+    int index = 0;
+    (detail::pack(record, index++, args), ...);
+    detail::push(record);
+}
+
+}  // namespace Log
+
+// 0 trace, 1 debug, 2 info, 3 warn, 4 error; set with -DQ14_LOG_LEVEL=<n> in CMake
+#ifndef Q14_LOG_LEVEL
+#ifdef NDEBUG
+#define Q14_LOG_LEVEL 2
+#else
+#define Q14_LOG_LEVEL 1
+#endif
+#endif
+
+#define Q14_LOG(level, ...)                                        \
+    do {                                                           \
+        if constexpr (static_cast<int>(level) >= Q14_LOG_LEVEL) { \
+            Log::write(level, __VA_ARGS__);                        \
+        }                                                          \
+    } while (0)
+
+#define Q14_LOG_TRACE(...) Q14_LOG(Log::Level::Trace, __VA_ARGS__)
+#define Q14_LOG_DEBUG(...) Q14_LOG(Log::Level::Debug, __VA_ARGS__)
+#define Q14_LOG_INFO(...) Q14_LOG(Log::Level::Info, __VA_ARGS__)
+#define Q14_LOG_WARN(...) Q14_LOG(Log::Level::Warn, __VA_ARGS__)
+#define Q14_LOG_ERROR(...) Q14_LOG(Log::Level::Error, __VA_ARGS__)
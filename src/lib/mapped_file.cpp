@@ -0,0 +1,97 @@
+#include "mapped_file.hpp"
+
+#include <SDL3/SDL.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define Q14_MAPPED_FILE_MMAP
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__) && !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define Q14_MAPPED_FILE_MMAP
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+
+#if defined(Q14_MAPPED_FILE_MMAP) && defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (data) {
+            m_file = file;
+            m_mapping = mapping;
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = static_cast<size_t>(size.QuadPart);
+        } else if (mapping) {
+            CloseHandle(mapping);
+        }
+    }
+    if (!m_data && file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+#elif defined(Q14_MAPPED_FILE_MMAP)
+    int fd = ::open(path, O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        auto size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = size;
+        }
+    }
+    if (fd >= 0) {
+        // The mapping stays valid without the descriptor
+        ::close(fd);
+    }
+#endif
+
+    if (!m_data) {
+        size_t size = 0;
+        void* data = SDL_LoadFile(path, &size);
+        if (!data) {
+            return false;
+        }
+        if (size == 0) {
+            SDL_free(data);
+            SDL_SetError("%s is empty", path);
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = size;
+        m_loaded = true;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        if (m_loaded) {
+            SDL_free(const_cast<uint8_t*>(m_data));
+        } else {
+#if defined(Q14_MAPPED_FILE_MMAP) && defined(_WIN32)
+            UnmapViewOfFile(m_data);
+            CloseHandle(m_mapping);
+            CloseHandle(m_file);
+            m_mapping = nullptr;
+            m_file = nullptr;
+#elif defined(Q14_MAPPED_FILE_MMAP)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        }
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_loaded = false;
+}
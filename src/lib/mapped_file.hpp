@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Read-only view of a whole file, memory mapped where the platform allows it and read into memory
+// otherwise (e.g. files inside the APK on Android)
+class MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False when the file is missing or empty, see SDL_GetError
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const {
+        return m_data != nullptr;
+    }
+
+    // True when the file is mapped rather than read
+    bool mapped() const {
+        return m_data && !m_loaded;
+    }
+
+    std::span<const uint8_t> data() const {
+        return {m_data, m_size};
+    }
+
+  private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_loaded = false;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
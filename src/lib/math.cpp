@@ -1,4 +1,7 @@
 #include "math.hpp"
+
+#include "random.hpp"
+
 bool Rect::contains(const Vec2& p) const {
     return p.x >= left() && p.x <= right() && p.y >= top() && p.y <= bottom();
 }
@@ -44,10 +47,14 @@ bool Rect::intersects(const Rect& other, Intersection* intersection = nullptr) c
 
 #endif
 
+void math::seed(uint64_t seed) {
+    seedThreadRandom(seed);
+}
+
 float math::random() {
-    return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+    return threadRandom().nextFloat();
 };
 
 float math::random(float min, float max) {
-    return min + (max - min) * random();
+    return threadRandom().range(min, max);
 };
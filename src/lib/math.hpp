@@ -110,6 +110,10 @@ inline bool is_zero(float f, float T = 0.01f) {
     return f < T && f > -T;
 }
 
+// Seeds the generator behind random(), so a session can be reproduced
+void seed(uint64_t seed);
+
+// Uniform in [0, 1), drawn from the calling thread's generator, see random.hpp
 float random();
 
 template <typename T>
@@ -0,0 +1,232 @@
+#include "memory.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "debugger.hpp"
+
+namespace {
+
+constexpr int TAG_COUNT = static_cast<int>(Memory::Tag::Count);
+constexpr const char* TAG_NAMES[TAG_COUNT] = {"untagged", "world",    "physics",
+                                              "render",   "debugger", "resources"};
+
+struct Counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<int64_t> liveBytes{0};
+};
+
+Counters s_counters[TAG_COUNT];
+// Snapshot of the previous Memory::debug call, main thread only
+Memory::TagStats s_lastStats[TAG_COUNT] = {};
+
+thread_local Memory::Tag t_tag = Memory::Tag::Untagged;
+thread_local uint64_t t_allocations = 0;
+thread_local uint64_t t_bytes = 0;
+
+#ifdef Q14_TRACK_ALLOCATIONS
+
+// Stored right in front of every allocation
+struct Header {
+    uint64_t size;
+    uint32_t offset;
+    Memory::Tag tag;
+};
+static_assert(sizeof(Header) == 16);
+
+void* allocate(std::size_t size, std::size_t alignment) {
+    alignment = alignment < alignof(Header) ? alignof(Header) : alignment;
+    auto raw = static_cast<char*>(std::malloc(size + sizeof(Header) + alignment - 1));
+    if (!raw) {
+        return nullptr;
+    }
+    auto address = reinterpret_cast<uintptr_t>(raw) + sizeof(Header);
+    address = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    auto ptr = reinterpret_cast<char*>(address);
+
+    auto header = reinterpret_cast<Header*>(ptr) - 1;
+    header->size = size;
+    header->offset = static_cast<uint32_t>(ptr - raw);
+    header->tag = t_tag;
+
+    auto& counters = s_counters[static_cast<int>(t_tag)];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    t_allocations++;
+    t_bytes += size;
+    return ptr;
+}
+
+void* allocateOrThrow(std::size_t size, std::size_t alignment) {
+    for (;;) {
+        if (auto ptr = allocate(size ? size : 1, alignment)) {
+            return ptr;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto header = static_cast<Header*>(ptr) - 1;
+    auto& counters = s_counters[static_cast<int>(header->tag)];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+    std::free(static_cast<char*>(ptr) - header->offset);
+}
+
+#endif
+
+}  // namespace
+
+#ifdef Q14_TRACK_ALLOCATIONS
+
+constexpr std::size_t DEFAULT_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* operator new(std::size_t size) {
+    return allocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+void* operator new[](std::size_t size) {
+    return allocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size ? size : 1, DEFAULT_ALIGNMENT);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size ? size : 1, DEFAULT_ALIGNMENT);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+    return allocate(size ? size : 1, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+    return allocate(size ? size : 1, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+#endif
+
+bool Memory::enabled() {
+#ifdef Q14_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* Memory::tagName(Tag tag) {
+    return TAG_NAMES[static_cast<int>(tag)];
+}
+
+Memory::TagStats Memory::stats(Tag tag) {
+    const auto& counters = s_counters[static_cast<int>(tag)];
+    return {counters.allocations.load(std::memory_order_relaxed),
+            counters.frees.load(std::memory_order_relaxed),
+            counters.bytes.load(std::memory_order_relaxed),
+            counters.liveBytes.load(std::memory_order_relaxed)};
+}
+
+uint64_t Memory::threadAllocations() {
+    return t_allocations;
+}
+
+uint64_t Memory::threadAllocatedBytes() {
+    return t_bytes;
+}
+
+Memory::Tag Memory::setTag(Tag tag) {
+    auto previous = t_tag;
+    t_tag = tag;
+    return previous;
+}
+
+#ifdef Q14_TRACK_ALLOCATIONS
+void* Memory::allocate(std::size_t size, std::size_t alignment, Tag tag) {
+    MemoryScope scope(tag);
+    return ::allocate(size ? size : 1, alignment);
+}
+
+void Memory::deallocate(void* ptr) {
+    ::deallocate(ptr);
+}
+#endif
+
+void Memory::debug(Debugger& debugger) {
+    TagStats current[TAG_COUNT];
+    TagStats last[TAG_COUNT];
+    for (int i = 0; i < TAG_COUNT; i++) {
+        current[i] = stats(static_cast<Tag>(i));
+        last[i] = s_lastStats[i];
+        s_lastStats[i] = current[i];
+    }
+
+    if (!debugger.pushSection("MEMORY")) {
+        return;
+    }
+    if (!enabled()) {
+        debugger.label("tracking", "off, configure with -DQ14_TRACK_ALLOCATIONS=ON");
+    }
+    for (int i = 0; i < TAG_COUNT; i++) {
+        auto allocations = current[i].allocations - last[i].allocations;
+        auto bytes = current[i].bytes - last[i].bytes;
+        debugger.label(TAG_NAMES[i], "%.1f KiB live, %llu allocs / %llu B this frame",
+                       current[i].liveBytes / 1024.0, static_cast<unsigned long long>(allocations),
+                       static_cast<unsigned long long>(bytes));
+    }
+    debugger.popSection();
+}
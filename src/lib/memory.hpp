@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Debugger;
+
+// Heap allocation tracking through replaced global operator new/delete.
+//
+// Only compiled in with the Q14_TRACK_ALLOCATIONS option. Allocations are attributed to the tag of
+// the innermost Q14_MEMORY_SCOPE on the allocating thread, frees to the tag they were allocated
+// with, so live bytes stay correct when memory is released elsewhere.
+namespace Memory {
+
+enum class Tag : uint8_t { Untagged, World, Physics, Render, Debugger, Resources, Count };
+
+struct TagStats {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;
+    int64_t liveBytes;
+};
+
+// False when the hooks are not compiled in, all counters stay zero then
+bool enabled();
+
+const char* tagName(Tag tag);
+TagStats stats(Tag tag);
+
+// Allocations made by the calling thread so far, for checking that a piece of code does not
+// allocate
+uint64_t threadAllocations();
+uint64_t threadAllocatedBytes();
+
+// Sets the tag of the calling thread, returns the previous one
+Tag setTag(Tag tag);
+
+#ifdef Q14_TRACK_ALLOCATIONS
+// For libraries that take allocator hooks instead of going through operator new, attributed to
+// the given tag whatever the scope of the calling thread is
+void* allocate(std::size_t size, std::size_t alignment, Tag tag);
+void deallocate(void* ptr);
+#endif
+
+// MEMORY section: live bytes, and allocations since the last call, per tag
+void debug(Debugger& debugger);
+
+}  // namespace Memory
+
+class MemoryScope {
+  public:
+    explicit MemoryScope(Memory::Tag tag) : m_previous(Memory::setTag(tag)){};
+    ~MemoryScope() {
+        Memory::setTag(m_previous);
+    }
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+  private:
+    Memory::Tag m_previous;
+};
+
+#define Q14_MEMORY_CONCAT_IMPL(a, b) a##b
+#define Q14_MEMORY_CONCAT(a, b) Q14_MEMORY_CONCAT_IMPL(a, b)
+
+#ifdef Q14_TRACK_ALLOCATIONS
+#define Q14_MEMORY_SCOPE(tag) \
+    MemoryScope Q14_MEMORY_CONCAT(memoryScope, __LINE__)(Memory::Tag::tag)
+#else
+#define Q14_MEMORY_SCOPE(tag) \
+    do {                      \
+    } while (0)
+#endif
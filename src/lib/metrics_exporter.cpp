@@ -0,0 +1,375 @@
+#include "metrics_exporter.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "memory.hpp"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define Q14_METRICS_SOCKETS
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+namespace {
+
+constexpr int FRAME_WINDOW = 1024;
+constexpr int MAX_GAUGES = 32;
+constexpr double QUANTILES[] = {0.5, 0.9, 0.99};
+// How often the thread checks for stop() while idle, how long a client has to send its request and
+// to read the reply. A client that stops reading can not keep the thread, and stop(), waiting.
+constexpr int POLL_MS = 250;
+constexpr int REQUEST_TIMEOUT_MS = 100;
+constexpr int SEND_TIMEOUT_MS = 1000;
+constexpr size_t REQUEST_SIZE = 2048;
+
+struct Gauge {
+    const char* name;
+    std::atomic<double> value;
+};
+
+// Written by the main thread only, read by the exporter thread
+std::atomic<float> s_frameTimes[FRAME_WINDOW];
+std::atomic<uint64_t> s_frameCount{0};
+std::atomic<double> s_frameSum{0.0};
+Gauge s_gauges[MAX_GAUGES];
+std::atomic<int> s_gaugeCount{0};
+
+// Main thread only
+bool s_running = false;
+SDL_Thread* s_thread = nullptr;
+
+std::atomic<bool> s_stop{false};
+int s_socket = -1;
+std::string s_unixPath;
+
+void appendf(std::string& out, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+    }
+}
+
+void formatFrames(std::string& out) {
+    const uint64_t count = s_frameCount.load(std::memory_order_acquire);
+    const double sum = s_frameSum.load(std::memory_order_relaxed);
+    const auto window = static_cast<size_t>(std::min<uint64_t>(count, FRAME_WINDOW));
+    std::vector<float> times(window);
+    for (size_t i = 0; i < window; i++) {
+        times[i] = s_frameTimes[(count - window + i) % FRAME_WINDOW].load(
+            std::memory_order_relaxed);
+    }
+
+    appendf(out, "# HELP q14_frame_time_ms Frame time of the last %d frames\n", FRAME_WINDOW);
+    appendf(out, "# TYPE q14_frame_time_ms summary\n");
+    for (double quantile : QUANTILES) {
+        double value = 0.0;
+        if (!times.empty()) {
+            // Nearest rank
+            auto rank = std::min(window - 1, static_cast<size_t>(quantile * window));
+            std::nth_element(times.begin(), times.begin() + rank, times.end());
+            value = times[rank];
+        }
+        appendf(out, "q14_frame_time_ms{quantile=\"%g\"} %.3f\n", quantile, value);
+    }
+    appendf(out, "q14_frame_time_ms_sum %.3f\n", sum);
+    appendf(out, "q14_frame_time_ms_count %llu\n", static_cast<unsigned long long>(count));
+    appendf(out, "# TYPE q14_frame_time_max_ms gauge\n");
+    appendf(out, "q14_frame_time_max_ms %.3f\n",
+            times.empty() ? 0.0 : *std::max_element(times.begin(), times.end()));
+}
+
+void formatMemory(std::string& out) {
+    if (Memory::enabled()) {
+        appendf(out, "# TYPE q14_memory_live_bytes gauge\n");
+        for (int i = 0; i < static_cast<int>(Memory::Tag::Count); i++) {
+            auto tag = static_cast<Memory::Tag>(i);
+            appendf(out, "q14_memory_live_bytes{tag=\"%s\"} %lld\n", Memory::tagName(tag),
+                    static_cast<long long>(Memory::stats(tag).liveBytes));
+        }
+        appendf(out, "# TYPE q14_memory_allocations_total counter\n");
+        for (int i = 0; i < static_cast<int>(Memory::Tag::Count); i++) {
+            auto tag = static_cast<Memory::Tag>(i);
+            appendf(out, "q14_memory_allocations_total{tag=\"%s\"} %llu\n", Memory::tagName(tag),
+                    static_cast<unsigned long long>(Memory::stats(tag).allocations));
+        }
+    }
+#ifdef __linux__
+    // Resident pages, the second field
+    if (FILE* file = std::fopen("/proc/self/statm", "r")) {
+        unsigned long long size = 0;
+        unsigned long long resident = 0;
+        if (std::fscanf(file, "%llu %llu", &size, &resident) == 2) {
+            appendf(out, "# TYPE q14_process_resident_bytes gauge\n");
+            appendf(out, "q14_process_resident_bytes %llu\n",
+                    resident * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE)));
+        }
+        std::fclose(file);
+    }
+#endif
+}
+
+std::string format() {
+    std::string out;
+    formatFrames(out);
+    const int count = s_gaugeCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        const auto& gauge = s_gauges[i];
+        appendf(out, "# TYPE %s gauge\n%s %.10g\n", gauge.name, gauge.name,
+                gauge.value.load(std::memory_order_relaxed));
+    }
+    formatMemory(out);
+    return out;
+}
+
+#ifdef Q14_METRICS_SOCKETS
+
+// Until the data is sent or the deadline (SDL_GetTicks) passes
+bool sendAll(int client, const std::string& data, uint64_t deadline) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+    const int flags = MSG_DONTWAIT;
+#endif
+    size_t sent = 0;
+    while (sent < data.size()) {
+        auto result = send(client, data.data() + sent, data.size() - sent, flags);
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            const uint64_t now = SDL_GetTicks();
+            pollfd fd{client, POLLOUT, 0};
+            if (now >= deadline || poll(&fd, 1, static_cast<int>(deadline - now)) <= 0) {
+                return false;
+            }
+            continue;
+        }
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+// Reads the request up to its blank line, closing with unread data would reset the connection.
+// Plain connections send nothing and get the metrics after the timeout.
+void serve(int client) {
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    char request[REQUEST_SIZE];
+    size_t received = 0;
+    for (;;) {
+        pollfd fd{client, POLLIN, 0};
+        if (received == sizeof(request) - 1 || poll(&fd, 1, REQUEST_TIMEOUT_MS) <= 0) {
+            break;
+        }
+        auto result = recv(client, request + received, sizeof(request) - 1 - received, 0);
+        if (result <= 0) {
+            break;
+        }
+        received += static_cast<size_t>(result);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) {
+            break;
+        }
+    }
+
+    auto body = format();
+    const uint64_t deadline = SDL_GetTicks() + SEND_TIMEOUT_MS;
+    if (received >= 4 && std::memcmp(request, "GET ", 4) == 0) {
+        std::string header;
+        appendf(header,
+                "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                body.size());
+        if (!sendAll(client, header, deadline)) {
+            close(client);
+            return;
+        }
+    }
+    sendAll(client, body, deadline);
+    shutdown(client, SHUT_WR);
+    close(client);
+}
+
+int run(void*) {
+    while (!s_stop.load(std::memory_order_acquire)) {
+        pollfd fd{s_socket, POLLIN, 0};
+        if (poll(&fd, 1, POLL_MS) <= 0) {
+            continue;
+        }
+        int client = accept(s_socket, nullptr, nullptr);
+        if (client >= 0) {
+            serve(client);
+        }
+    }
+    return 0;
+}
+
+// "unix:<path>" or a port on 127.0.0.1, never reachable from other machines
+int openSocket(const char* address) {
+    int fd = -1;
+    if (std::strncmp(address, "unix:", 5) == 0) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        const char* path = address + 5;
+        if (std::strlen(path) == 0 || std::strlen(path) >= sizeof(addr.sun_path)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MetricsExporter: bad socket path %s", path);
+            return -1;
+        }
+        std::strcpy(addr.sun_path, path);
+        // A stale socket of an earlier run is replaced, anything else at the path is left alone
+        struct stat info;
+        if (lstat(path, &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                             "MetricsExporter: %s exists and is not a socket", path);
+                return -1;
+            }
+            unlink(path);
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            s_unixPath = path;
+        } else if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        const int port = std::atoi(address);
+        if (port <= 0 || port > 65535) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MetricsExporter: bad port %s", address);
+            return -1;
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0) {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+    if (fd >= 0 && listen(fd, 4) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MetricsExporter: could not listen on %s: %s",
+                     address, std::strerror(errno));
+    }
+    return fd;
+}
+
+#endif
+
+}  // namespace
+
+bool MetricsExporter::start(const char* address) {
+    if (s_running) {
+        return true;
+    }
+#ifdef Q14_METRICS_SOCKETS
+    s_socket = openSocket(address);
+    if (s_socket < 0) {
+        return false;
+    }
+    s_stop.store(false, std::memory_order_release);
+    s_thread = SDL_CreateThread(run, "q14-metrics", nullptr);
+    if (!s_thread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MetricsExporter: no thread: %s",
+                     SDL_GetError());
+        stop();
+        return false;
+    }
+    s_running = true;
+    SDL_Log("MetricsExporter: serving on %s", address);
+    return true;
+#else
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                 "MetricsExporter: sockets are not supported on this platform, not serving %s",
+                 address);
+    return false;
+#endif
+}
+
+void MetricsExporter::stop() {
+#ifdef Q14_METRICS_SOCKETS
+    s_stop.store(true, std::memory_order_release);
+    if (s_thread) {
+        SDL_WaitThread(s_thread, nullptr);
+        s_thread = nullptr;
+    }
+    if (s_socket >= 0) {
+        close(s_socket);
+        s_socket = -1;
+    }
+    if (!s_unixPath.empty()) {
+        unlink(s_unixPath.c_str());
+        s_unixPath.clear();
+    }
+#endif
+    s_running = false;
+}
+
+bool MetricsExporter::running() {
+    return s_running;
+}
+
+void MetricsExporter::frame(double milliseconds) {
+    if (!s_running) {
+        return;
+    }
+    const uint64_t count = s_frameCount.load(std::memory_order_relaxed);
+    s_frameTimes[count % FRAME_WINDOW].store(static_cast<float>(milliseconds),
+                                             std::memory_order_relaxed);
+    s_frameSum.store(s_frameSum.load(std::memory_order_relaxed) + milliseconds,
+                     std::memory_order_relaxed);
+    s_frameCount.store(count + 1, std::memory_order_release);
+}
+
+void MetricsExporter::gauge(const char* name, double value) {
+    if (!s_running) {
+        return;
+    }
+    const int count = s_gaugeCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (s_gauges[i].name == name) {
+            s_gauges[i].value.store(value, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (count < MAX_GAUGES) {
+        s_gauges[count].name = name;
+        s_gauges[count].value.store(value, std::memory_order_relaxed);
+        s_gaugeCount.store(count + 1, std::memory_order_release);
+    }
+}
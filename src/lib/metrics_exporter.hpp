@@ -0,0 +1,26 @@
+#pragma once
+
+// Serves runtime metrics in the Prometheus text format, for unattended runs such as soak tests:
+// frame time quantiles, renderer and physics counters, object counts and memory use.
+//
+//   MetricsExporter::gauge("q14_physics_bodies", counters.bodyCount);
+//
+// The main thread only stores the latest values into atomics. A background thread accepts the
+// connections, computes the quantiles and formats the reply, so a scrape never stalls a frame.
+// Listens on a localhost TCP port ("9114") or a UNIX domain socket ("unix:/tmp/q14.sock") and
+// answers HTTP GETs (Prometheus, curl) as well as plain connections (socat, nc). POSIX only.
+namespace MetricsExporter {
+
+// Starts serving on address, false (and logged) if the socket can not be opened
+bool start(const char* address);
+// Stops the thread and closes the socket
+void stop();
+bool running();
+
+// The duration of the last frame, called by App once per frame
+void frame(double milliseconds);
+// The latest value of a metric, main thread only. The name must be a string literal and a valid
+// Prometheus metric name. Does nothing while not running.
+void gauge(const char* name, double value);
+
+}  // namespace MetricsExporter
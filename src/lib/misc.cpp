@@ -1,5 +1,52 @@
 #include "misc.hpp"
 
+#include <SDL3/SDL.h>
+
+#include <cstdlib>
+#include <mutex>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
 const char* version() {
     return FULL_VERSION_STRING;
 };
+
+std::string prefPath(const char* file) {
+    std::string path;
+    char* dir = SDL_GetPrefPath("HerrKamrat", "q14");
+    if (dir) {
+        path = dir;
+        SDL_free(dir);
+    }
+    return path + file;
+}
+
+const char* typeName(const std::type_info& type) {
+    static std::mutex mutex;
+    static std::unordered_map<std::type_index, std::string> names;
+    std::lock_guard lock(mutex);
+    auto [it, inserted] = names.try_emplace(type);
+    if (inserted) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* name = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        it->second = status == 0 && name ? name : type.name();
+        std::free(name);
+#else
+        // MSVC names are readable already, apart from the "class " or "struct " prefix
+        std::string_view name = type.name();
+        for (std::string_view prefix : {"class ", "struct "}) {
+            if (name.starts_with(prefix)) {
+                name.remove_prefix(prefix.size());
+            }
+        }
+        it->second = name;
+#endif
+    }
+    return it->second.c_str();
+}
@@ -1,3 +1,13 @@
 #pragma once
 
+#include <string>
+#include <typeinfo>
+
 const char* version();
+
+// Path of a file in the writable per-user directory of the application
+std::string prefPath(const char* file);
+
+// Readable name of a type, e.g. "PhysicsBodyComponent" for typeid(component). Demangled once per
+// type, the string lives until exit.
+const char* typeName(const std::type_info& type);
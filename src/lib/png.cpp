@@ -0,0 +1,616 @@
+#include "png.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#define STBI_ONLY_PNG
+
+// #pragma warning(push, 0)
+// #pragma GCC diagnostic push
+// #pragma GCC diagnostic ignored "-Wunused-function"
+#include "third_party/stb_image.h"
+// #pragma GCC diagnostic pop
+// #pragma warning(pop)
+
+namespace {
+
+constexpr uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+constexpr uint32_t MAX_SIZE = 16384;
+constexpr uint8_t COLOR_INDEXED = 3;
+
+struct Chunk {
+    uint32_t type;
+    std::span<const uint8_t> data;
+};
+
+struct Header {
+    uint32_t width;
+    uint32_t height;
+    uint8_t bitDepth;
+    uint8_t colorType;
+    uint8_t interlace;
+};
+
+constexpr uint32_t chunkType(const char (&name)[5]) {
+    return uint32_t(uint8_t(name[0])) << 24 | uint32_t(uint8_t(name[1])) << 16 |
+           uint32_t(uint8_t(name[2])) << 8 | uint32_t(uint8_t(name[3]));
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+
+// Walks the chunks after the signature, false at the end or on a truncated chunk
+bool nextChunk(std::span<const uint8_t> data, size_t& offset, Chunk& chunk) {
+    if (offset + 12 > data.size()) {
+        return false;
+    }
+    uint32_t length = readU32(&data[offset]);
+    if (length > data.size() - offset - 12) {
+        return false;
+    }
+    chunk.type = readU32(&data[offset + 4]);
+    chunk.data = data.subspan(offset + 8, length);
+    offset += 12 + length;
+    return true;
+}
+
+bool readHeader(std::span<const uint8_t> data, Header& header) {
+    size_t offset = sizeof(SIGNATURE);
+    Chunk chunk;
+    if (data.size() < sizeof(SIGNATURE) || std::memcmp(data.data(), SIGNATURE, 8) != 0 ||
+        !nextChunk(data, offset, chunk) || chunk.type != chunkType("IHDR") ||
+        chunk.data.size() < 13) {
+        SDL_SetError("Png: not a PNG image");
+        return false;
+    }
+    header.width = readU32(&chunk.data[0]);
+    header.height = readU32(&chunk.data[4]);
+    header.bitDepth = chunk.data[8];
+    header.colorType = chunk.data[9];
+    header.interlace = chunk.data[12];
+    if (header.width == 0 || header.height == 0 || header.width > MAX_SIZE ||
+        header.height > MAX_SIZE) {
+        SDL_SetError("Png: unsupported size %ux%u", header.width, header.height);
+        return false;
+    }
+    return true;
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = SDL_abs(p - a);
+    int pb = SDL_abs(p - b);
+    int pc = SDL_abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Reverses the row filter from src into row, prior is the previous unfiltered row or zeros. The
+// filter unit is one byte for indexed images.
+bool unfilter(uint8_t filter, const uint8_t* src, uint8_t* row, const uint8_t* prior,
+              size_t length) {
+    switch (filter) {
+        case 0:
+            std::memcpy(row, src, length);
+            return true;
+        case 1:
+            row[0] = src[0];
+            for (size_t i = 1; i < length; i++) {
+                row[i] = uint8_t(src[i] + row[i - 1]);
+            }
+            return true;
+        case 2:
+            for (size_t i = 0; i < length; i++) {
+                row[i] = uint8_t(src[i] + prior[i]);
+            }
+            return true;
+        case 3:
+            row[0] = uint8_t(src[0] + prior[0] / 2);
+            for (size_t i = 1; i < length; i++) {
+                row[i] = uint8_t(src[i] + (row[i - 1] + prior[i]) / 2);
+            }
+            return true;
+        case 4:
+            row[0] = uint8_t(src[0] + prior[0]);
+            for (size_t i = 1; i < length; i++) {
+                row[i] = uint8_t(src[i] + paeth(row[i - 1], prior[i], prior[i - 1]));
+            }
+            return true;
+    }
+    return false;
+}
+
+void store(uint8_t* out, uint32_t color) {
+    std::memcpy(out, &color, 4);
+}
+
+// Palette lookup of one row, the palette holds RGBA in memory order so every pixel is a single
+// 32 bit store. Sub-byte depths are unrolled per source byte.
+// No SIMD: the embedded images are at most 24x24 pixels (102 of the 284 arrays are 24x24 at 1, 2
+// or 4 bits, 180 are 18x18 and 2 are 16x16), so a row is at most 96 bytes of output and setting up
+// a shuffle costs about as much as the lookups. Per-image setup such as the Huffman tables
+// dominates at these sizes.
+void expand(const uint8_t* row, uint8_t* out, uint32_t width, int bits, const uint32_t* palette) {
+    uint32_t x = 0;
+    switch (bits) {
+        case 8:
+            for (; x < width; x++) {
+                store(out + x * 4, palette[row[x]]);
+            }
+            return;
+        case 4:
+            for (; x + 2 <= width; x += 2, row++) {
+                store(out + x * 4, palette[*row >> 4]);
+                store(out + x * 4 + 4, palette[*row & 0xf]);
+            }
+            break;
+        case 2:
+            for (; x + 4 <= width; x += 4, row++) {
+                store(out + x * 4, palette[*row >> 6]);
+                store(out + x * 4 + 4, palette[(*row >> 4) & 3]);
+                store(out + x * 4 + 8, palette[(*row >> 2) & 3]);
+                store(out + x * 4 + 12, palette[*row & 3]);
+            }
+            break;
+        case 1:
+            for (; x + 8 <= width; x += 8, row++) {
+                for (int bit = 0; bit < 8; bit++) {
+                    store(out + (x + bit) * 4, palette[(*row >> (7 - bit)) & 1]);
+                }
+            }
+            break;
+    }
+    // The pixels of the last, partial byte
+    const uint8_t mask = uint8_t((1 << bits) - 1);
+    for (int shift = 8 - bits; x < width; x++, shift -= bits) {
+        store(out + x * 4, palette[(*row >> shift) & mask]);
+    }
+}
+
+// Canonical Huffman code, decoded through a table for codes up to FAST_BITS long and bit by bit
+// for the rest
+struct Huffman {
+    static constexpr int FAST_BITS = 9;
+    // (length << 9) | symbol, 0 when the code is longer than FAST_BITS
+    uint16_t fast[1 << FAST_BITS];
+    uint16_t count[16];
+    uint16_t symbol[288];
+
+    bool build(const uint8_t* lengths, int n) {
+        std::memset(count, 0, sizeof(count));
+        for (int i = 0; i < n; i++) {
+            count[lengths[i]]++;
+        }
+        count[0] = 0;
+        uint16_t offsets[16];
+        int left = 1;
+        offsets[1] = 0;
+        for (int length = 1; length < 16; length++) {
+            left = left * 2 - count[length];
+            if (left < 0) {
+                return false;
+            }
+            if (length < 15) {
+                offsets[length + 1] = uint16_t(offsets[length] + count[length]);
+            }
+        }
+        std::memset(fast, 0, sizeof(fast));
+        uint16_t codes[16];
+        int code = 0;
+        for (int length = 1; length < 16; length++) {
+            code = (code + count[length - 1]) << 1;
+            codes[length] = uint16_t(code);
+        }
+        for (int i = 0; i < n; i++) {
+            int length = lengths[i];
+            if (length == 0) {
+                continue;
+            }
+            symbol[offsets[length]++] = uint16_t(i);
+            int value = codes[length]++;
+            if (length <= FAST_BITS) {
+                // The stream holds codes most significant bit first
+                for (int j = reverse(value, length); j < (1 << FAST_BITS); j += 1 << length) {
+                    fast[j] = uint16_t(length << 9 | i);
+                }
+            }
+        }
+        return true;
+    }
+
+    static int reverse(int value, int length) {
+        value = ((value & 0xaaaa) >> 1) | ((value & 0x5555) << 1);
+        value = ((value & 0xcccc) >> 2) | ((value & 0x3333) << 2);
+        value = ((value & 0xf0f0) >> 4) | ((value & 0x0f0f) << 4);
+        value = ((value & 0xff00) >> 8) | ((value & 0x00ff) << 8);
+        return value >> (16 - length);
+    }
+};
+
+struct FixedTables {
+    Huffman literals;
+    Huffman distances;
+
+    FixedTables() {
+        uint8_t lengths[288 + 30];
+        std::memset(lengths, 8, 144);
+        std::memset(lengths + 144, 9, 112);
+        std::memset(lengths + 256, 7, 24);
+        std::memset(lengths + 280, 8, 8);
+        std::memset(lengths + 288, 5, 30);
+        literals.build(lengths, 288);
+        distances.build(lengths + 288, 30);
+    }
+};
+
+constexpr uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,   10,  11,  13,
+                                      15, 17, 19, 23, 27, 31, 35,  43,  51,  59,
+                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DISTANCE_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                        33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385,
+                                        24577};
+constexpr uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Inflates the zlib stream split over the IDAT chunks and hands every scanline to the row
+// callback as soon as it is complete, while it is still in cache. The filtered bytes stay in
+// `out` because later matches refer back to them.
+class RowInflater {
+  public:
+    RowInflater(std::span<const uint8_t> png, size_t offset, std::span<uint8_t> out,
+                size_t rowStride)
+        : m_png(png), m_offset(offset), m_out(out), m_rowStride(rowStride) {}
+
+    template <class RowFn>
+    bool run(RowFn&& row) {
+        if (!nextIdat()) {
+            SDL_SetError("Png: no image data");
+            return false;
+        }
+        // zlib header: deflate with a window of at most 32K, no preset dictionary
+        uint32_t cmf = bits(8);
+        uint32_t flg = bits(8);
+        if ((cmf & 0xf) != 8 || (cmf >> 4) > 7 || (cmf << 8 | flg) % 31 != 0 || (flg & 0x20)) {
+            SDL_SetError("Png: invalid zlib header");
+            return false;
+        }
+        bool last = false;
+        while (!last) {
+            last = bits(1);
+            uint32_t type = bits(2);
+            bool ok = false;
+            if (type == 0) {
+                ok = stored();
+            } else if (type == 1) {
+                static const FixedTables fixed;
+                ok = codes(fixed.literals, fixed.distances, row);
+            } else if (type == 2) {
+                ok = dynamicTables() && codes(m_literals, m_distances, row);
+            }
+            if (!ok || m_overrun > 8) {
+                return fail();
+            }
+        }
+        if (m_pos != m_out.size() || !rows(row)) {
+            return fail();
+        }
+        return true;
+    }
+
+  private:
+    // Keeps the error of a failed row callback
+    bool fail() {
+        if (!m_rowFailed) {
+            SDL_SetError("Png: corrupt image data");
+        }
+        return false;
+    }
+
+    // Advances to the next IDAT chunk, false once the IDAT sequence ends
+    bool nextIdat() {
+        Chunk chunk;
+        while (nextChunk(m_png, m_offset, chunk)) {
+            if (chunk.type == chunkType("IDAT")) {
+                m_in = chunk.data.data();
+                m_inEnd = m_in + chunk.data.size();
+                m_seenIdat = true;
+                return true;
+            }
+            if (m_seenIdat) {
+                break;
+            }
+        }
+        m_offset = m_png.size();
+        return false;
+    }
+
+    void refill() {
+        while (m_bitCount <= 56) {
+            if (m_in == m_inEnd && !nextIdat()) {
+                // Past the end of the stream, only a corrupt stream gets far with the padding
+                m_overrun++;
+                m_bitCount += 8;
+                continue;
+            }
+            m_bits |= uint64_t(*m_in++) << m_bitCount;
+            m_bitCount += 8;
+        }
+    }
+
+    uint32_t bits(int count) {
+        if (m_bitCount < count) {
+            refill();
+        }
+        uint32_t value = uint32_t(m_bits & ((uint64_t(1) << count) - 1));
+        m_bits >>= count;
+        m_bitCount -= count;
+        return value;
+    }
+
+    int decode(const Huffman& huffman) {
+        if (m_bitCount < 16) {
+            refill();
+        }
+        uint16_t entry = huffman.fast[m_bits & ((1 << Huffman::FAST_BITS) - 1)];
+        if (entry) {
+            m_bits >>= entry >> 9;
+            m_bitCount -= entry >> 9;
+            return entry & 0x1ff;
+        }
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int length = 1; length < 16; length++) {
+            code |= bits(1);
+            int count = huffman.count[length];
+            if (code - first < count) {
+                return huffman.symbol[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    bool stored() {
+        bits(m_bitCount % 8);
+        uint32_t length = bits(16);
+        if ((bits(16) ^ 0xffff) != length || length > m_out.size() - m_pos) {
+            return false;
+        }
+        while (length--) {
+            m_out[m_pos++] = uint8_t(bits(8));
+        }
+        return true;
+    }
+
+    bool dynamicTables() {
+        constexpr uint8_t ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                       11, 4,  12, 3, 13, 2, 14, 1, 15};
+        int literalCount = int(bits(5)) + 257;
+        int distanceCount = int(bits(5)) + 1;
+        int codeCount = int(bits(4)) + 4;
+        uint8_t codeLengths[19] = {};
+        for (int i = 0; i < codeCount; i++) {
+            codeLengths[ORDER[i]] = uint8_t(bits(3));
+        }
+        Huffman lengthCode;
+        if (literalCount > 286 || distanceCount > 30 || !lengthCode.build(codeLengths, 19)) {
+            return false;
+        }
+        uint8_t lengths[286 + 30];
+        int n = 0;
+        while (n < literalCount + distanceCount) {
+            int symbol = decode(lengthCode);
+            if (symbol < 0) {
+                return false;
+            }
+            if (symbol < 16) {
+                lengths[n++] = uint8_t(symbol);
+                continue;
+            }
+            uint8_t value = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (n == 0) {
+                    return false;
+                }
+                value = lengths[n - 1];
+                repeat = 3 + int(bits(2));
+            } else if (symbol == 17) {
+                repeat = 3 + int(bits(3));
+            } else {
+                repeat = 11 + int(bits(7));
+            }
+            if (n + repeat > literalCount + distanceCount) {
+                return false;
+            }
+            std::memset(lengths + n, value, repeat);
+            n += repeat;
+        }
+        return lengths[256] != 0 && m_literals.build(lengths, literalCount) &&
+               m_distances.build(lengths + literalCount, distanceCount);
+    }
+
+    template <class RowFn>
+    bool codes(const Huffman& literals, const Huffman& distances, RowFn& row) {
+        uint8_t* out = m_out.data();
+        const size_t size = m_out.size();
+        for (;;) {
+            int symbol = decode(literals);
+            if (symbol < 256) {
+                if (symbol < 0 || m_pos == size) {
+                    return false;
+                }
+                out[m_pos++] = uint8_t(symbol);
+            } else if (symbol == 256) {
+                return true;
+            } else {
+                symbol -= 257;
+                if (symbol >= 29) {
+                    return false;
+                }
+                size_t length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+                int distanceSymbol = decode(distances);
+                if (distanceSymbol < 0 || distanceSymbol >= 30) {
+                    return false;
+                }
+                size_t distance =
+                    DISTANCE_BASE[distanceSymbol] + bits(DISTANCE_EXTRA[distanceSymbol]);
+                if (distance > m_pos || length > size - m_pos) {
+                    return false;
+                }
+                // Byte by byte, the match may overlap the bytes it produces
+                const uint8_t* from = out + m_pos - distance;
+                for (size_t i = 0; i < length; i++) {
+                    out[m_pos + i] = from[i];
+                }
+                m_pos += length;
+            }
+            if (m_pos >= m_rowEnd + m_rowStride && !rows(row)) {
+                return false;
+            }
+        }
+    }
+
+    // Hands out every complete row not handed out yet
+    template <class RowFn>
+    bool rows(RowFn& row) {
+        while (m_rowEnd + m_rowStride <= m_pos) {
+            if (!row(&m_out[m_rowEnd])) {
+                m_rowFailed = true;
+                return false;
+            }
+            m_rowEnd += m_rowStride;
+        }
+        return true;
+    }
+
+    std::span<const uint8_t> m_png;
+    size_t m_offset;
+    const uint8_t* m_in = nullptr;
+    const uint8_t* m_inEnd = nullptr;
+    bool m_seenIdat = false;
+    uint64_t m_bits = 0;
+    int m_bitCount = 0;
+    int m_overrun = 0;
+
+    std::span<uint8_t> m_out;
+    size_t m_pos = 0;
+    size_t m_rowStride;
+    // Start of the first row not handed out yet
+    size_t m_rowEnd = 0;
+
+    bool m_rowFailed = false;
+
+    Huffman m_literals;
+    Huffman m_distances;
+};
+
+bool decodeIndexed(std::span<const uint8_t> data, const Header& header, PixelBuffer pixels) {
+    // Palette as RGBA in memory order, entries past the end of PLTE are opaque black
+    uint8_t colors[256][4];
+    for (auto& color : colors) {
+        color[0] = color[1] = color[2] = 0;
+        color[3] = 255;
+    }
+    // Everything up to the first IDAT, the palette chunks have to come before it
+    size_t offset = sizeof(SIGNATURE);
+    size_t idatOffset = offset;
+    Chunk chunk;
+    while (nextChunk(data, offset, chunk) && chunk.type != chunkType("IDAT")) {
+        if (chunk.type == chunkType("PLTE")) {
+            for (size_t i = 0; i < SDL_min(chunk.data.size() / 3, size_t(256)); i++) {
+                std::memcpy(colors[i], &chunk.data[i * 3], 3);
+            }
+        } else if (chunk.type == chunkType("tRNS")) {
+            for (size_t i = 0; i < SDL_min(chunk.data.size(), size_t(256)); i++) {
+                colors[i][3] = chunk.data[i];
+            }
+        }
+        idatOffset = offset;
+    }
+    uint32_t palette[256];
+    std::memcpy(palette, colors, sizeof(palette));
+
+    const size_t rowLength = (size_t(header.width) * header.bitDepth + 7) / 8;
+    const size_t stride = rowLength + 1;
+    // The filtered image, plus the current and previous unfiltered rows, reused by every decode
+    // on this thread
+    thread_local std::vector<uint8_t> filtered;
+    thread_local std::vector<uint8_t> rows;
+    filtered.resize(stride * header.height);
+    rows.assign(rowLength * 2, 0);
+    uint8_t* current = rows.data();
+    uint8_t* prior = rows.data() + rowLength;
+
+    uint32_t y = 0;
+    RowInflater inflater(data, idatOffset, filtered, stride);
+    return inflater.run([&](const uint8_t* src) {
+        if (!unfilter(src[0], src + 1, current, prior, rowLength)) {
+            SDL_SetError("Png: invalid filter %d", src[0]);
+            return false;
+        }
+        expand(current, &pixels.data[y * pixels.stride], header.width, header.bitDepth, palette);
+        std::swap(current, prior);
+        y++;
+        return true;
+    });
+}
+
+bool decodeGeneric(std::span<const uint8_t> data, const Header& header, PixelBuffer pixels) {
+    int width = 0;
+    int height = 0;
+    uint8_t* image = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width,
+                                           &height, nullptr, 4);
+    if (!image) {
+        SDL_SetError("Png: %s", stbi_failure_reason());
+        return false;
+    }
+    for (int y = 0; y < height; y++) {
+        std::memcpy(&pixels.data[y * pixels.stride], image + y * width * 4, width * 4);
+    }
+    stbi_image_free(image);
+    return true;
+}
+
+}  // namespace
+
+bool Png::readInfo(std::span<const uint8_t> data, ImageInfo& info) {
+    Header header;
+    if (!readHeader(data, header)) {
+        return false;
+    }
+    info.width = static_cast<int>(header.width);
+    info.height = static_cast<int>(header.height);
+    info.format = PixelFormat::RGBA;
+    return true;
+}
+
+bool Png::decode(std::span<const uint8_t> data, PixelBuffer pixels) {
+    Header header;
+    if (!readHeader(data, header)) {
+        return false;
+    }
+    if (pixels.stride < static_cast<int>(header.width * 4) ||
+        pixels.data.size() < size_t(pixels.stride) * (header.height - 1) + header.width * 4) {
+        SDL_SetError("Png: destination too small for %ux%u", header.width, header.height);
+        return false;
+    }
+    bool indexed = header.colorType == COLOR_INDEXED && header.interlace == 0 &&
+                   (header.bitDepth == 1 || header.bitDepth == 2 || header.bitDepth == 4 ||
+                    header.bitDepth == 8);
+    return indexed ? decodeIndexed(data, header, pixels) : decodeGeneric(data, header, pixels);
+}
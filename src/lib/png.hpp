@@ -0,0 +1,21 @@
+#pragma once
+
+#include <span>
+
+#include "gfx.hpp"
+
+// PNG decoding into caller provided memory, e.g. a reused staging buffer.
+//
+// Indexed color images (bit depth 1, 2, 4 or 8, not interlaced), which is what the embedded
+// assets are, have their own decoder: every scanline is unfiltered and expanded into the
+// destination as soon as it is inflated. Everything else is decoded by stb_image and copied.
+// Errors are reported through SDL_GetError.
+namespace Png {
+
+// Size of the image from its header, without decoding it
+bool readInfo(std::span<const uint8_t> data, ImageInfo& info);
+
+// Decodes to RGBA, pixels must hold the size from readInfo
+bool decode(std::span<const uint8_t> data, PixelBuffer pixels);
+
+}  // namespace Png
@@ -0,0 +1,295 @@
+#include "profiler.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <span>
+
+namespace {
+
+constexpr uint64_t EVENT_CAPACITY = 1 << 14;
+constexpr uint64_t FRAME_CAPACITY = 256;
+constexpr uint32_t MAX_THREADS = 64;
+
+// One event of a ring. Other threads read the ring while its owner keeps writing, so the slot is
+// a seqlock: sequence is odd while the owner writes it and 2 * (index + 1) once event index is
+// complete. Readers check it before and after copying the fields and drop torn events.
+struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+    std::atomic<uint32_t> depth{0};
+};
+
+struct ThreadBuffer {
+    uint32_t thread = 0;
+    uint32_t depth = 0;
+    std::atomic<uint64_t> head{0};
+    Slot slots[EVENT_CAPACITY];
+};
+
+// Buffers are registered once and never moved or freed, so readers walk them without a lock,
+// crash handlers included. The mutex only orders registrations.
+std::mutex s_mutex;
+ThreadBuffer* s_buffers[MAX_THREADS] = {};
+std::atomic<uint32_t> s_bufferCount{0};
+std::atomic<bool> s_paused{false};
+
+Profiler::Frame s_frames[FRAME_CAPACITY];
+std::atomic<uint64_t> s_frameHead{0};
+uint64_t s_frameStart = 0;
+uint32_t s_frameThread = 0;
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+// Threads past MAX_THREADS are not recorded
+thread_local bool t_untracked = false;
+
+ThreadBuffer* threadBuffer() {
+    if (!t_buffer && !t_untracked) {
+        std::lock_guard lock(s_mutex);
+        const uint32_t count = s_bufferCount.load(std::memory_order_relaxed);
+        if (count == MAX_THREADS) {
+            t_untracked = true;
+            return nullptr;
+        }
+        auto buffer = new ThreadBuffer();
+        buffer->thread = count;
+        s_buffers[count] = buffer;
+        s_bufferCount.store(count + 1, std::memory_order_release);
+        t_buffer = buffer;
+    }
+    return t_buffer;
+}
+
+std::span<ThreadBuffer* const> buffers() {
+    return {s_buffers, s_bufferCount.load(std::memory_order_acquire)};
+}
+
+uint64_t firstIndex(uint64_t head) {
+    return head > EVENT_CAPACITY ? head - EVENT_CAPACITY : 0;
+}
+
+// False when the slot does not hold event index (anymore), or the owner wrote it meanwhile
+bool readEvent(const ThreadBuffer& buffer, uint64_t index, Profiler::Event& event) {
+    const auto& slot = buffer.slots[index % EVENT_CAPACITY];
+    const uint64_t sequence = 2 * (index + 1);
+    if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+        return false;
+    }
+    // Acquire loads of the fields keep the second sequence load after them: a field written after
+    // the sequence went odd makes that load see the odd (or a later) sequence
+    event.name = slot.name.load(std::memory_order_acquire);
+    event.start = slot.start.load(std::memory_order_acquire);
+    event.end = slot.end.load(std::memory_order_acquire);
+    event.depth = slot.depth.load(std::memory_order_acquire);
+    event.thread = buffer.thread;
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void writeEscaped(FILE* file, const char* str) {
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*str, file);
+    }
+}
+
+}  // namespace
+
+void Profiler::beginFrame() {
+    if (auto buffer = threadBuffer()) {
+        s_frameThread = buffer->thread;
+    }
+    s_frameStart = SDL_GetPerformanceCounter();
+}
+
+void Profiler::endFrame() {
+    if (s_paused.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto head = s_frameHead.load(std::memory_order_relaxed);
+    s_frames[head % FRAME_CAPACITY] = {head, s_frameStart, SDL_GetPerformanceCounter()};
+    s_frameHead.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setPaused(bool paused) {
+    s_paused = paused;
+}
+
+bool Profiler::paused() {
+    return s_paused;
+}
+
+bool Profiler::lastFrame(Frame& frame) {
+    auto head = s_frameHead.load(std::memory_order_acquire);
+    if (head == 0) {
+        return false;
+    }
+    frame = s_frames[(head - 1) % FRAME_CAPACITY];
+    return true;
+}
+
+void Profiler::collect(const Frame& frame, std::vector<Event>& events) {
+    for (auto buffer : buffers()) {
+        // Events are stored in the order they end, so walk back until they end before the frame.
+        // The oldest events may be overwritten meanwhile, those are skipped.
+        auto head = buffer->head.load(std::memory_order_acquire);
+        for (auto i = head; i > firstIndex(head); i--) {
+            Event event;
+            if (!readEvent(*buffer, i - 1, event)) {
+                continue;
+            }
+            if (event.end < frame.start) {
+                break;
+            }
+            if (event.start >= frame.start && event.end <= frame.end) {
+                events.push_back(event);
+            }
+        }
+    }
+}
+
+bool Profiler::writeChromeTrace(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Profiler: could not open %s", path);
+        return false;
+    }
+
+    const double toMicroseconds = 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+    uint64_t base = UINT64_MAX;
+    {
+        auto head = s_frameHead.load(std::memory_order_acquire);
+        auto first = head > FRAME_CAPACITY ? head - FRAME_CAPACITY : 0;
+        if (head > first) {
+            base = s_frames[first % FRAME_CAPACITY].start;
+        }
+    }
+
+    for (auto buffer : buffers()) {
+        auto head = buffer->head.load(std::memory_order_acquire);
+        Event event;
+        for (auto i = firstIndex(head); i < head; i++) {
+            if (readEvent(*buffer, i, event)) {
+                base = std::min(base, event.start);
+                break;
+            }
+        }
+    }
+    if (base == UINT64_MAX) {
+        base = 0;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool firstEvent = true;
+    auto writeEvent = [&](const char* name, uint64_t start, uint64_t end, uint32_t thread) {
+        std::fprintf(file, "%s{\"name\": \"", firstEvent ? "" : ",\n");
+        writeEscaped(file, name);
+        std::fprintf(file, "\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u", thread);
+        std::fprintf(file, ", \"ts\": %.3f, \"dur\": %.3f}", (start - base) * toMicroseconds,
+                     (end - start) * toMicroseconds);
+        firstEvent = false;
+    };
+
+    {
+        auto head = s_frameHead.load(std::memory_order_acquire);
+        auto first = head > FRAME_CAPACITY ? head - FRAME_CAPACITY : 0;
+        for (auto i = first; i < head; i++) {
+            const auto& frame = s_frames[i % FRAME_CAPACITY];
+            writeEvent("Frame", frame.start, frame.end, s_frameThread);
+        }
+    }
+    for (auto buffer : buffers()) {
+        auto head = buffer->head.load(std::memory_order_acquire);
+        Event event;
+        for (auto i = firstIndex(head); i < head; i++) {
+            // Events older than base were overwritten since it was picked
+            if (readEvent(*buffer, i, event) && event.start >= base) {
+                writeEvent(event.name, event.start, event.end, event.thread);
+            }
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    SDL_Log("Profiler: wrote trace to %s", path);
+    return true;
+}
+
+size_t Profiler::copyEvents(uint64_t since, std::span<Event> events) {
+    // Merges the rings newest first, so it is the oldest events that do not fit. A ring's events
+    // are written as they end, so its walk stops at the first one that ended before since.
+    const auto rings = buffers();
+    uint64_t cursors[MAX_THREADS];
+    uint64_t firsts[MAX_THREADS];
+    Event next[MAX_THREADS];
+    bool valid[MAX_THREADS];
+    auto advance = [&](size_t r) {
+        valid[r] = false;
+        while (cursors[r] > firsts[r]) {
+            cursors[r]--;
+            if (readEvent(*rings[r], cursors[r], next[r])) {
+                valid[r] = next[r].end >= since;
+                return;
+            }
+        }
+    };
+    for (size_t r = 0; r < rings.size(); r++) {
+        cursors[r] = rings[r]->head.load(std::memory_order_acquire);
+        firsts[r] = firstIndex(cursors[r]);
+        advance(r);
+    }
+
+    size_t count = 0;
+    while (count < events.size()) {
+        size_t newest = rings.size();
+        for (size_t r = 0; r < rings.size(); r++) {
+            if (valid[r] && (newest == rings.size() || next[r].end > next[newest].end)) {
+                newest = r;
+            }
+        }
+        if (newest == rings.size()) {
+            break;
+        }
+        events[count++] = next[newest];
+        advance(newest);
+    }
+    std::reverse(events.begin(), events.begin() + count);
+    return count;
+}
+
+double Profiler::toMilliseconds(uint64_t ticks) {
+    return ticks * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+uint64_t Profiler::begin() {
+    if (auto buffer = threadBuffer()) {
+        buffer->depth++;
+    }
+    return SDL_GetPerformanceCounter();
+}
+
+void Profiler::end(const char* name, uint64_t start) {
+    auto end = SDL_GetPerformanceCounter();
+    auto buffer = t_buffer;
+    if (!buffer) {
+        return;
+    }
+    buffer->depth--;
+    if (s_paused.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto head = buffer->head.load(std::memory_order_relaxed);
+    auto& slot = buffer->slots[head % EVENT_CAPACITY];
+    slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_release);
+    slot.start.store(start, std::memory_order_release);
+    slot.end.store(end, std::memory_order_release);
+    slot.depth.store(buffer->depth, std::memory_order_release);
+    slot.sequence.store(2 * (head + 1), std::memory_order_release);
+    buffer->head.store(head + 1, std::memory_order_release);
+}
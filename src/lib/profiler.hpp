@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Scoped CPU timers, recorded into a ring buffer per thread.
+//
+//   void PhysicsSystem::update(...) {
+//       Q14_PROFILE_SCOPE("PhysicsSystem::update");
+//       ...
+//   }
+//
+// The name must be a string literal, only the pointer is stored. Compiled out unless Q14_PROFILER
+// is defined, see the Q14_PROFILER option in CMakeLists.txt.
+//
+// Any thread may read the rings while their owners record: every event is published through a
+// sequence number, and readers skip events that were overwritten while they copied them, so they
+// see whole events or none. The oldest events of a busy ring may go missing that way. Threads
+// beyond the 64th are not recorded.
+namespace Profiler {
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t depth;
+    uint32_t thread;
+};
+
+struct Frame {
+    uint64_t index;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Marks the frame boundaries, called by App on the main thread
+void beginFrame();
+void endFrame();
+
+// Stops recording new events and frames, so the captured ones can be inspected
+void setPaused(bool paused);
+bool paused();
+
+// The most recent completed frame, false if there is none yet
+bool lastFrame(Frame& frame);
+// Appends the events of all threads that lie within the frame
+void collect(const Frame& frame, std::vector<Event>& events);
+// Writes every captured event in the Chrome trace event format (chrome://tracing, Perfetto)
+bool writeChromeTrace(const char* path);
+// Copies the captured events of all threads that end at or after since, oldest first, and returns
+// how many. When there are more than events.size(), the newest ones are kept. Takes no locks and
+// does not allocate, so crash handlers may call it.
+size_t copyEvents(uint64_t since, std::span<Event> events);
+
+double toMilliseconds(uint64_t ticks);
+
+// Used by ProfileScope
+uint64_t begin();
+void end(const char* name, uint64_t start);
+
+}  // namespace Profiler
+
+class ProfileScope {
+  public:
+    explicit ProfileScope(const char* name) : m_name(name), m_start(Profiler::begin()){};
+    ~ProfileScope() {
+        Profiler::end(m_name, m_start);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#define Q14_PROFILE_CONCAT_IMPL(a, b) a##b
+#define Q14_PROFILE_CONCAT(a, b) Q14_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef Q14_PROFILER
+#define Q14_PROFILE_SCOPE(name) ProfileScope Q14_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define Q14_PROFILE_SCOPE(name) \
+    do {                        \
+    } while (0)
+#endif
@@ -0,0 +1,66 @@
+#include "random.hpp"
+
+#include <atomic>
+
+namespace {
+
+constexpr int LANES = 8;
+
+std::atomic<uint64_t> s_seed{0};
+std::atomic<uint64_t> s_nextStream{0};
+
+inline uint32_t rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+struct ThreadRandom {
+    ThreadRandom() : stream(s_nextStream.fetch_add(1)), random(s_seed.load(), stream) {
+    }
+
+    uint64_t stream;
+    math::Random random;
+};
+
+thread_local ThreadRandom t_random;
+
+}  // namespace
+
+void math::Random::fill(std::span<float> out, float min, float max) {
+    alignas(32) uint32_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+    for (int lane = 0; lane < LANES; lane++) {
+        s0[lane] = next();
+        s1[lane] = next();
+        s2[lane] = next();
+        s3[lane] = next() | 1u;  // xoshiro state must not be all zero
+    }
+
+    const float scale = (max - min) * 0x1.0p-24f;
+    size_t i = 0;
+    const size_t count = out.size();
+    float* data = out.data();
+    for (; i + LANES <= count; i += LANES) {
+        for (int lane = 0; lane < LANES; lane++) {
+            uint32_t result = s0[lane] + s3[lane];
+            uint32_t t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotl(s3[lane], 11);
+            data[i + lane] = min + static_cast<float>(result >> 8) * scale;
+        }
+    }
+    for (; i < count; i++) {
+        data[i] = range(min, max);
+    }
+}
+
+math::Random& math::threadRandom() {
+    return t_random.random;
+}
+
+void math::seedThreadRandom(uint64_t seed) {
+    s_seed = seed;
+    t_random.random.seed(seed, t_random.stream);
+}
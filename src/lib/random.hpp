@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace math {
+
+// Small PCG32 generator (64 bit state, selectable stream), so independent users such as worlds
+// and worker threads can draw numbers without sharing state
+class Random {
+  public:
+    Random(uint64_t seed = 0, uint64_t stream = 0) {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream = 0) {
+        m_state = 0;
+        m_increment = (stream << 1u) | 1u;
+        next();
+        m_state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t state = m_state;
+        m_state = state * 6364136223846793005ull + m_increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((state >> 18u) ^ state) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(state >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    uint64_t next64() {
+        return (static_cast<uint64_t>(next()) << 32) | next();
+    }
+
+    // Uniform in [0, 1)
+    float nextFloat() {
+        return (next() >> 8) * 0x1.0p-24f;
+    }
+
+    float range(float min, float max) {
+        return min + (max - min) * nextFloat();
+    }
+
+    // Uniform in [min, max)
+    int range(int min, int max) {
+        auto span = static_cast<uint64_t>(static_cast<int64_t>(max) - min);
+        return min + static_cast<int>((static_cast<uint64_t>(next()) * span) >> 32);
+    }
+
+    // Fills out with uniform values in [min, max), using eight interleaved xoshiro128+ lanes
+    // seeded from this generator, so the loop vectorizes on SSE2/NEON/wasm-simd
+    void fill(std::span<float> out, float min = 0.0f, float max = 1.0f);
+
+  private:
+    uint64_t m_state;
+    uint64_t m_increment;
+};
+
+// The calling thread's generator; every thread gets its own stream of the global seed
+Random& threadRandom();
+
+// Sets the global seed and reseeds the calling thread's generator
+void seedThreadRandom(uint64_t seed);
+
+}  // namespace math
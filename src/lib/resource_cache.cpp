@@ -0,0 +1,206 @@
+#include "resource_cache.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "debugger.hpp"
+#include "memory.hpp"
+#include "resource_loader.hpp"
+
+namespace ResourceCache {
+
+struct Entry {
+    const uint8_t* key;
+    RenderContext* context;
+    Texture texture;
+    int references;
+    uint64_t bytes;
+    // Position in s_keys
+    size_t index;
+};
+
+}  // namespace ResourceCache
+
+namespace {
+
+using ResourceCache::Entry;
+
+std::unordered_map<const uint8_t*, Entry> s_entries;
+// The keys of s_entries in no particular order, for the debugger's list to index
+std::vector<const uint8_t*> s_keys;
+uint64_t s_hits = 0;
+uint64_t s_misses = 0;
+uint64_t s_residentBytes = 0;
+
+const Archive* s_archive = nullptr;
+
+Entry* find(const uint8_t* key) {
+    auto it = s_entries.find(key);
+    return it != s_entries.end() ? &it->second : nullptr;
+}
+
+Entry* insert(RenderContext& context, const uint8_t* key, Texture texture) {
+    if (texture.key.check == 0) {
+        return nullptr;
+    }
+    auto bytes = static_cast<uint64_t>(texture.width) * texture.height * 4;
+    auto& entry = s_entries[key];
+    entry = {key, &context, texture, 0, bytes, s_keys.size()};
+    s_keys.push_back(key);
+    s_residentBytes += bytes;
+    return &entry;
+}
+
+// Archive entries are keyed by their blob, which identical assets share, embedded assets by
+// their data
+std::pair<const uint8_t*, Archive::Id> source(const ResourceCache::Asset& asset) {
+    auto id = s_archive ? s_archive->find(asset.name) : Archive::INVALID_ID;
+    auto key = id != Archive::INVALID_ID ? s_archive->stored(id).data() : asset.embedded.data();
+    return {key, id};
+}
+
+void release(Entry* entry) {
+    if (--entry->references > 0) {
+        return;
+    }
+    entry->context->deleteTexture(entry->texture);
+    s_residentBytes -= entry->bytes;
+    // Swap with the last key so removing stays constant time
+    s_keys[entry->index] = s_keys.back();
+    s_entries[s_keys.back()].index = entry->index;
+    s_keys.pop_back();
+    s_entries.erase(entry->key);
+}
+
+}  // namespace
+
+TextureRef::TextureRef(ResourceCache::Entry* entry) : m_entry(entry) {
+    if (m_entry) {
+        m_entry->references++;
+    }
+}
+
+TextureRef::TextureRef(const TextureRef& other) : TextureRef(other.m_entry) {
+}
+
+TextureRef::TextureRef(TextureRef&& other) noexcept : m_entry(other.m_entry) {
+    other.m_entry = nullptr;
+}
+
+TextureRef& TextureRef::operator=(TextureRef other) noexcept {
+    std::swap(m_entry, other.m_entry);
+    return *this;
+}
+
+TextureRef::~TextureRef() {
+    if (m_entry) {
+        release(m_entry);
+    }
+}
+
+Texture TextureRef::get() const {
+    return m_entry ? m_entry->texture : Texture{{0, 0}, 0, 0};
+}
+
+TextureRef ResourceCache::load(RenderContext& context, const Asset& asset, TextureOptions options) {
+    auto [key, id] = source(asset);
+    if (auto entry = find(key)) {
+        s_hits++;
+        return TextureRef(entry);
+    }
+    if (id != Archive::INVALID_ID) {
+        // Archive entries are read and inflated by the loader
+        TextureRef texture;
+        load(context, std::span(&asset, 1), std::span(&texture, 1), options);
+        return texture;
+    }
+    Q14_MEMORY_SCOPE(Resources);
+    s_misses++;
+    auto texture = ResourceLoader::loadTexture(context, asset.embedded, options);
+    if (texture.key.check == 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ResourceCache: failed to load %.*s: %s",
+                     static_cast<int>(asset.name.size()), asset.name.data(), SDL_GetError());
+        return {};
+    }
+    return TextureRef(insert(context, key, texture));
+}
+
+void ResourceCache::mount(const Archive* archive) {
+    s_archive = archive && archive->isOpen() ? archive : nullptr;
+}
+
+void ResourceCache::load(RenderContext& context,
+                         std::span<const Asset> assets,
+                         std::span<TextureRef> textures,
+                         TextureOptions options) {
+    SDL_assert(textures.size() >= assets.size());
+    Q14_MEMORY_SCOPE(Resources);
+
+    // Start decoding every asset that is not cached, once, then upload them together
+    std::vector<std::pair<const uint8_t*, ResourceLoader::Handle>> loads;
+    for (const auto& asset : assets) {
+        auto [key, id] = source(asset);
+        bool loading = std::any_of(loads.begin(), loads.end(),
+                                   [&](const auto& load) { return load.first == key; });
+        if (find(key) || loading) {
+            continue;
+        }
+        auto handle = id != Archive::INVALID_ID
+                          ? ResourceLoader::loadTextureAsync(*s_archive, id, options, asset.name)
+                          : ResourceLoader::loadTextureAsync(asset.embedded, options, asset.name);
+        loads.emplace_back(key, handle);
+    }
+    if (!loads.empty()) {
+        ResourceLoader::finish(context);
+    }
+
+    for (size_t i = 0; i < assets.size(); i++) {
+        auto key = source(assets[i]).first;
+        auto entry = find(key);
+        if (entry) {
+            s_hits++;
+        } else {
+            s_misses++;
+            auto load = std::find_if(loads.begin(), loads.end(),
+                                     [&](const auto& load) { return load.first == key; });
+            // Done with, so an asset sharing the key is not looked up or logged again
+            if (load != loads.end()) {
+                entry = insert(context, key, ResourceLoader::texture(load->second));
+                if (!entry) {
+                    // The worker logged the decode error
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ResourceCache: failed to load %.*s",
+                                 static_cast<int>(assets[i].name.size()), assets[i].name.data());
+                }
+                loads.erase(load);
+            }
+        }
+        textures[i] = TextureRef(entry);
+    }
+}
+
+ResourceCache::Stats ResourceCache::stats() {
+    return {s_hits, s_misses, static_cast<int>(s_entries.size()), s_residentBytes};
+}
+
+void ResourceCache::debug(Debugger& debugger) {
+    if (!debugger.pushSection("RESOURCES")) {
+        return;
+    }
+    auto lookups = s_hits + s_misses;
+    debugger.label("hit rate", "%.1f%% of %llu loads",
+                   lookups ? 100.0 * s_hits / lookups : 0.0,
+                   static_cast<unsigned long long>(lookups));
+    debugger.label("textures", "%d, %.1f KiB resident", static_cast<int>(s_entries.size()),
+                   s_residentBytes / 1024.0);
+    debugger.list("resources", static_cast<int>(s_keys.size()),
+                  [](int index, Debugger::ListRow& row) {
+                      const auto& entry = s_entries[s_keys[index]];
+                      SDL_snprintf(row.text, sizeof(row.text), "%p  %dx%d  %d refs",
+                                   static_cast<const void*>(entry.key), entry.texture.width,
+                                   entry.texture.height, entry.references);
+                      // Releases move the last key into the gap
+                      row.id = reinterpret_cast<uintptr_t>(entry.key);
+                  });
+    debugger.popSection();
+}
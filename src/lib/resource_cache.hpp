@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "archive.hpp"
+#include "gfx.hpp"
+
+class Debugger;
+
+namespace ResourceCache {
+struct Entry;
+}
+
+// Shared reference to a cached texture, the texture is deleted when the last reference goes away
+class TextureRef {
+  public:
+    TextureRef() = default;
+    explicit TextureRef(ResourceCache::Entry* entry);
+    TextureRef(const TextureRef& other);
+    TextureRef(TextureRef&& other) noexcept;
+    TextureRef& operator=(TextureRef other) noexcept;
+    ~TextureRef();
+
+    Texture get() const;
+    explicit operator bool() const {
+        return m_entry != nullptr;
+    }
+
+  private:
+    ResourceCache::Entry* m_entry = nullptr;
+};
+
+// Textures created from assets, keyed by the address of the asset's data, so every
+// Resources::Images span or archive blob is decoded and uploaded once for as long as someone holds
+// a reference. Render thread only, like RenderContext.
+namespace ResourceCache {
+
+// Looked up by name in the mounted archive, the embedded data is the fallback
+struct Asset {
+    std::string_view name;
+    std::span<const uint8_t> embedded;
+};
+
+struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    int textures;
+    // Pixel memory of the cached textures, as uploaded
+    uint64_t residentBytes;
+};
+
+// Resolves the asset like the batch load below, so both share the cached texture
+TextureRef load(RenderContext& context, const Asset& asset, TextureOptions options = {});
+// Archive to look assets up in first, nullptr to only use the embedded data. It must stay open
+// while mounted.
+void mount(const Archive* archive);
+
+// Loads several assets at once, the misses are decoded in parallel by the ResourceLoader workers
+void load(RenderContext& context,
+          std::span<const Asset> assets,
+          std::span<TextureRef> textures,
+          TextureOptions options = {});
+
+Stats stats();
+
+// RESOURCES section: hit rate, resident bytes and the cached textures
+void debug(Debugger& debugger);
+
+}  // namespace ResourceCache
@@ -1,40 +1,458 @@
 #include "resource_loader.hpp"
 
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_NO_STDIO
-#define STBI_ONLY_PNG
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
 
-// #pragma warning(push, 0)
-// #pragma GCC diagnostic push
-// #pragma GCC diagnostic ignored "-Wunused-function"
-#include "third_party/stb_image.h"
-// #pragma GCC diagnostic pop
-// #pragma warning(pop)
+#include "image_cache.hpp"
+#include "memory.hpp"
+#include "png.hpp"
+#include "profiler.hpp"
+#include "startup_timeline.hpp"
 
-Image ResourceLoader::loadImage(std::span<const uint8_t> data) {
-    Image image;  //{{}, {}, {nullptr}};
+namespace {
+
+constexpr int MAX_WORKERS = 8;
+// Larger images get a staging page of their own size
+constexpr size_t STAGING_PAGE_SIZE = 1 << 20;
+
+// Either the encoded data, or an archive entry holding it
+struct Source {
+    std::span<const uint8_t> data;
+    const Archive* archive = nullptr;
+    Archive::Id id = Archive::INVALID_ID;
+    // For the startup timeline
+    std::string_view name;
+};
+
+// Names unnamed assets in the startup timeline, as ResourceCache keys them
+const void* address(const Source& source) {
+    return source.archive ? source.archive->stored(source.id).data() : source.data.data();
+}
+
+struct Load {
+    // Odd while the slot is in use, bumped when it is taken and when it is released, so handles
+    // of earlier loads in the slot don't match
+    uint32_t generation = 0;
+    Source source;
+    TextureOptions options;
+    ResourceLoader::State state = ResourceLoader::State::Pending;
+    // Set between decode and upload: a slice of staging page, or ImageCache pixels without a page
+    ImageInfo info{};
+    PixelRef pixels{};
+    int page = -1;
+    Texture texture{{0, 0}, 0, 0};
+};
+
+// Decoded pixels wait for their upload in slices of these pages instead of an allocation each. A
+// page is reused once every slice in it is uploaded, so loads stop allocating when the pages
+// cover what is in flight at once.
+struct StagingPage {
+    std::unique_ptr<uint8_t[]> memory;
+    size_t size = 0;
+    size_t used = 0;
+    int slices = 0;
+};
+
+// Everything below is guarded by s_mutex, decoding and uploading happen outside of it
+std::mutex s_mutex;
+std::condition_variable s_jobAdded;
+std::condition_variable s_loadDone;
+std::deque<Load> s_loads;
+// Released slots of s_loads, reused before it grows
+std::vector<uint32_t> s_freeLoads;
+std::deque<ResourceLoader::Handle> s_jobs;
+std::deque<ResourceLoader::Handle> s_decoded;
+std::vector<StagingPage> s_pages;
+int s_pending = 0;
+bool s_running = false;
+
+std::vector<SDL_Thread*> s_workers;
+
+// Decode target of loadTexture, render thread only. Grows to the largest image and is reused.
+std::vector<uint8_t> s_staging;
+
+// The load of handle, null once it was released
+Load* find(ResourceLoader::Handle handle) {
+    if (handle.generation % 2 == 0 || handle.index >= s_loads.size()) {
+        return nullptr;
+    }
+    auto& load = s_loads[handle.index];
+    return load.generation == handle.generation ? &load : nullptr;
+}
+
+void release(uint32_t index) {
+    auto& load = s_loads[index];
+    const uint32_t generation = load.generation + 1;
+    load = {};
+    load.generation = generation;
+    s_freeLoads.push_back(index);
+}
+
+// A slice of size bytes in a staging page, null when out of memory. Guarded by s_mutex.
+uint8_t* allocateStaging(size_t size, int& page) {
+    size = (size + 15) & ~static_cast<size_t>(15);
+    auto it = std::find_if(s_pages.begin(), s_pages.end(), [size](const StagingPage& candidate) {
+        return candidate.size - candidate.used >= size;
+    });
+    if (it == s_pages.end()) {
+        StagingPage added;
+        added.size = std::max(size, STAGING_PAGE_SIZE);
+        added.memory.reset(new (std::nothrow) uint8_t[added.size]);
+        if (!added.memory) {
+            SDL_SetError("ResourceLoader: no memory for a %zu byte staging page", added.size);
+            return nullptr;
+        }
+        s_pages.push_back(std::move(added));
+        it = s_pages.end() - 1;
+    }
+    page = static_cast<int>(it - s_pages.begin());
+    auto slice = it->memory.get() + it->used;
+    it->used += size;
+    it->slices++;
+    return slice;
+}
+
+// Guarded by s_mutex
+void releaseStaging(int page) {
+    if (page < 0) {
+        return;
+    }
+    auto& staging = s_pages[page];
+    if (--staging.slices == 0) {
+        staging.used = 0;
+    }
+}
 
-    auto buffer = static_cast<const stbi_uc*>(data.data());
-    auto len = static_cast<int>(data.size());
-    int channels = 4;
+void decode(ResourceLoader::Handle handle, const Source& source) {
+    // Reused by every load on this thread, only compressed archive entries need it
+    thread_local std::vector<uint8_t> buffer;
+    const uint64_t start = SDL_GetPerformanceCounter();
+    auto data = source.archive ? source.archive->read(source.id, buffer) : source.data;
+    ImageInfo info{};
+    PixelRef pixels{};
+    int page = -1;
+    bool decoded = false;
+    if (ImageCache::isOpen()) {
+        Image image;
+        decoded = ImageCache::load(data, image);
+        info = image.info;
+        pixels = image.pixels;
+    } else if (Png::readInfo(data, info)) {
+        const int stride = info.width * 4;
+        const size_t size = static_cast<size_t>(stride) * info.height;
+        uint8_t* slice;
+        {
+            std::lock_guard lock(s_mutex);
+            slice = allocateStaging(size, page);
+        }
+        decoded = slice && Png::decode(data, {{slice, size}, stride});
+        pixels = {{slice, size}, stride};
+    }
+    StartupTimeline::asset(source.name, address(source), StartupTimeline::Step::Decode, start,
+                           SDL_GetPerformanceCounter());
 
-    uint8_t* img;
-    int w, h;
-    img = stbi_load_from_memory(buffer, len, &w, &h, nullptr, channels);
+    std::lock_guard lock(s_mutex);
+    auto load = find(handle);
+    if (!load || !decoded) {
+        releaseStaging(page);
+    }
+    if (!load) {
+        // Dropped by shutdown
+        return;
+    }
+    if (!decoded) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ResourceLoader: failed to decode image %u: %s",
+                     handle.index, SDL_GetError());
+        load->state = ResourceLoader::State::Failed;
+        s_pending--;
+    } else {
+        load->info = info;
+        load->pixels = pixels;
+        load->page = page;
+        s_decoded.push_back(handle);
+    }
+    s_loadDone.notify_all();
+}
 
-    if (!img) {
-        return image;
+int worker(void*) {
+    Memory::setTag(Memory::Tag::Resources);
+    for (;;) {
+        ResourceLoader::Handle handle;
+        Source source;
+        {
+            std::unique_lock lock(s_mutex);
+            s_jobAdded.wait(lock, [] { return !s_running || !s_jobs.empty(); });
+            if (!s_running) {
+                return 0;
+            }
+            handle = s_jobs.front();
+            s_jobs.pop_front();
+            source = find(handle)->source;
+        }
+        Q14_PROFILE_SCOPE("ResourceLoader::decode");
+        decode(handle, source);
     }
+}
 
-    image.info.width = w;
-    image.info.height = h;
+int upload(RenderContext& context, uint64_t budgetTicks) {
+    Q14_PROFILE_SCOPE("ResourceLoader::upload");
+    Q14_MEMORY_SCOPE(Resources);
+    const uint64_t start = SDL_GetPerformanceCounter();
+    int uploaded = 0;
+    for (;;) {
+        ResourceLoader::Handle handle;
+        ImageInfo info;
+        PixelRef pixels;
+        int page;
+        TextureOptions options;
+        Source source;
+        {
+            std::lock_guard lock(s_mutex);
+            if (s_decoded.empty()) {
+                break;
+            }
+            handle = s_decoded.front();
+            s_decoded.pop_front();
+            auto& load = *find(handle);
+            info = load.info;
+            pixels = load.pixels;
+            page = load.page;
+            options = load.options;
+            source = load.source;
+        }
 
-    image.pixels.data = {img, static_cast<size_t>(w * h * channels)};
-    image.pixels.stride = w * 4;
+        const uint64_t uploadStart = SDL_GetPerformanceCounter();
+        auto texture = context.createTexture(info, pixels, options);
+        StartupTimeline::asset(source.name, address(source), StartupTimeline::Step::Upload,
+                               uploadStart, SDL_GetPerformanceCounter());
+        uploaded++;
+        {
+            std::lock_guard lock(s_mutex);
+            releaseStaging(page);
+            if (auto load = find(handle)) {
+                load->texture = texture;
+                load->state = texture.key.check != 0 ? ResourceLoader::State::Ready
+                                                     : ResourceLoader::State::Failed;
+                s_pending--;
+            }
+        }
+        s_loadDone.notify_all();
+
+        if (SDL_GetPerformanceCounter() - start >= budgetTicks) {
+            break;
+        }
+    }
+    return uploaded;
+}
 
-    image.data = {img, stbi_image_free};
+}  // namespace
 
-    // SDL_Log("data: %d x %d", data.size(), data.size_bytes());
-    // SDL_Log("img: %d x %d x %d", w, h, n);
+Image ResourceLoader::loadImage(std::span<const uint8_t> data) {
+    ImageInfo info;
+    if (!Png::readInfo(data, info)) {
+        return {};
+    }
+    const int stride = info.width * 4;
+    const size_t size = static_cast<size_t>(stride) * info.height;
+    auto pixels = static_cast<uint8_t*>(SDL_malloc(size));
+    if (!pixels || !Png::decode(data, {{pixels, size}, stride})) {
+        SDL_free(pixels);
+        return {};
+    }
+
+    Image image;
+    image.info = info;
+    image.pixels = {{pixels, size}, stride};
+    image.data = {pixels, SDL_free};
     return image;
-}
\ No newline at end of file
+}
+
+Texture ResourceLoader::loadTexture(RenderContext& context,
+                                    std::span<const uint8_t> data,
+                                    TextureOptions options) {
+    Q14_PROFILE_SCOPE("ResourceLoader::loadTexture");
+    const uint64_t start = SDL_GetPerformanceCounter();
+    auto record = [&](StartupTimeline::Step step, uint64_t stepStart) {
+        const uint64_t now = SDL_GetPerformanceCounter();
+        StartupTimeline::asset({}, data.data(), step, stepStart, now);
+        return now;
+    };
+    if (ImageCache::isOpen()) {
+        // Premultiplied pixels from the cache, usually without decoding
+        Image image;
+        if (!ImageCache::load(data, image)) {
+            return {{0, 0}, 0, 0};
+        }
+        const uint64_t decoded = record(StartupTimeline::Step::Decode, start);
+        auto texture = context.createTexture(image.info, image.pixels, options);
+        record(StartupTimeline::Step::Upload, decoded);
+        return texture;
+    }
+
+    ImageInfo info;
+    if (!Png::readInfo(data, info)) {
+        return {{0, 0}, 0, 0};
+    }
+    // Written once, so a static texture: streaming ones keep a shadow copy of their pixels on
+    // some renderers (GL, GLES2)
+    const int stride = info.width * 4;
+    const size_t size = static_cast<size_t>(stride) * info.height;
+    if (s_staging.size() < size) {
+        s_staging.resize(size);
+    }
+    PixelBuffer pixels{{s_staging.data(), size}, stride};
+    if (!Png::decode(data, pixels)) {
+        return {{0, 0}, 0, 0};
+    }
+    const uint64_t decoded = record(StartupTimeline::Step::Decode, start);
+    auto texture = context.createTexture(info, {pixels.data, stride}, options);
+    record(StartupTimeline::Step::Upload, decoded);
+    return texture;
+}
+
+void ResourceLoader::init(int workers) {
+    if (!s_workers.empty()) {
+        return;
+    }
+    if (workers <= 0) {
+        workers = SDL_GetCPUCount() - 1;
+    }
+    workers = SDL_clamp(workers, 1, MAX_WORKERS);
+
+    {
+        std::lock_guard lock(s_mutex);
+        s_running = true;
+    }
+    for (int i = 0; i < workers; i++) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "q14-decode-%d", i);
+        auto thread = SDL_CreateThread(worker, name, nullptr);
+        if (!thread) {
+            break;
+        }
+        s_workers.push_back(thread);
+    }
+    if (s_workers.empty()) {
+        // No threads on this platform, images are decoded by the caller
+        std::lock_guard lock(s_mutex);
+        s_running = false;
+    }
+    SDL_Log("ResourceLoader: %d decode workers", static_cast<int>(s_workers.size()));
+}
+
+void ResourceLoader::shutdown() {
+    {
+        std::lock_guard lock(s_mutex);
+        s_running = false;
+    }
+    s_jobAdded.notify_all();
+    for (auto thread : s_workers) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    s_workers.clear();
+
+    // The slots are released rather than dropped, handles from before stay invalid after init()
+    std::lock_guard lock(s_mutex);
+    s_jobs.clear();
+    s_decoded.clear();
+    for (uint32_t i = 0; i < s_loads.size(); i++) {
+        if (s_loads[i].generation % 2 == 1) {
+            release(i);
+        }
+    }
+    s_pending = 0;
+    s_pages.clear();
+}
+
+namespace {
+
+ResourceLoader::Handle queue(const Source& source, TextureOptions options) {
+    ResourceLoader::Handle handle;
+    bool async;
+    {
+        std::lock_guard lock(s_mutex);
+        if (s_freeLoads.empty()) {
+            s_freeLoads.push_back(static_cast<uint32_t>(s_loads.size()));
+            s_loads.emplace_back();
+        }
+        handle.index = s_freeLoads.back();
+        s_freeLoads.pop_back();
+        auto& load = s_loads[handle.index];
+        handle.generation = ++load.generation;
+        load.source = source;
+        load.options = options;
+        s_pending++;
+        async = s_running;
+        if (async) {
+            s_jobs.push_back(handle);
+        }
+    }
+    if (async) {
+        s_jobAdded.notify_one();
+    } else {
+        decode(handle, source);
+    }
+    return handle;
+}
+
+}  // namespace
+
+ResourceLoader::Handle ResourceLoader::loadTextureAsync(std::span<const uint8_t> data,
+                                                        TextureOptions options,
+                                                        std::string_view name) {
+    return queue({data, nullptr, Archive::INVALID_ID, name}, options);
+}
+
+ResourceLoader::Handle ResourceLoader::loadTextureAsync(const Archive& archive,
+                                                        Archive::Id id,
+                                                        TextureOptions options,
+                                                        std::string_view name) {
+    return queue({{}, &archive, id, name}, options);
+}
+
+int ResourceLoader::uploadDecoded(RenderContext& context, float budgetMs) {
+    auto budget = static_cast<uint64_t>(budgetMs * SDL_GetPerformanceFrequency() / 1000.0);
+    return upload(context, budget);
+}
+
+void ResourceLoader::finish(RenderContext& context) {
+    Q14_PROFILE_SCOPE("ResourceLoader::finish");
+    for (;;) {
+        {
+            std::unique_lock lock(s_mutex);
+            s_loadDone.wait(lock, [] { return s_pending == 0 || !s_decoded.empty(); });
+            if (s_pending == 0) {
+                return;
+            }
+        }
+        upload(context, UINT64_MAX);
+    }
+}
+
+ResourceLoader::State ResourceLoader::state(Handle handle) {
+    std::lock_guard lock(s_mutex);
+    auto load = find(handle);
+    return load ? load->state : State::Failed;
+}
+
+Texture ResourceLoader::texture(Handle handle) {
+    std::lock_guard lock(s_mutex);
+    auto load = find(handle);
+    if (!load || load->state == State::Pending) {
+        return {{0, 0}, 0, 0};
+    }
+    auto texture = load->texture;
+    release(handle.index);
+    return texture;
+}
+
+int ResourceLoader::pendingCount() {
+    std::lock_guard lock(s_mutex);
+    return s_pending;
+}
@@ -1,9 +1,70 @@
 #pragma once
 
+#include <string_view>
+
+#include "archive.hpp"
 #include "gfx.hpp"
 
 namespace ResourceLoader {
 
 Image loadImage(std::span<const uint8_t> data);
+// Decodes into a staging buffer reused by every call, then creates a static texture from it,
+// render thread only. While the ImageCache is open, the cached pixels are uploaded instead. An
+// empty texture on error, see SDL_GetError.
+Texture loadTexture(RenderContext& context,
+                    std::span<const uint8_t> data,
+                    TextureOptions options = {});
+
+// Asynchronous texture loading: PNGs are decoded on a pool of worker threads into slices of
+// staging pages the loader reuses, the textures are created from them on the render thread by
+// uploadDecoded() or finish().
+//
+//   auto handle = ResourceLoader::loadTextureAsync(Resources::Images::Tiles::Tile_0001);
+//   ...
+//   ResourceLoader::uploadDecoded(renderContext, 2.0f);  // once per frame
+//   if (ResourceLoader::state(handle) != ResourceLoader::State::Pending) {
+//       auto texture = ResourceLoader::texture(handle);
+//   }
+//
+// The encoded data is not copied and must outlive the load, which holds for the embedded
+// resources. Without init(), or without thread support, loads are decoded by the caller. Workers
+// go through the ImageCache while it is open, so shut down before closing it.
+struct Handle {
+    uint32_t index;
+    // Tells apart the loads that reuse a slot
+    uint32_t generation;
+};
+
+enum class State { Pending, Ready, Failed };
+
+// Starts the workers, one less than the CPU count when workers is 0
+void init(int workers = 0);
+// Stops the workers, decoded but not uploaded images are dropped
+void shutdown();
+
+// The name labels the load in the StartupTimeline and must outlive the load like the data
+Handle loadTextureAsync(std::span<const uint8_t> data,
+                        TextureOptions options = {},
+                        std::string_view name = {});
+// An archive entry, read (and inflated) by the worker, the archive must stay open until the load
+// is done
+Handle loadTextureAsync(const Archive& archive,
+                        Archive::Id id,
+                        TextureOptions options = {},
+                        std::string_view name = {});
+
+// Creates textures from decoded images until budgetMs is used up, at least one per call so the
+// queue always drains. Returns the number of textures created.
+int uploadDecoded(RenderContext& context, float budgetMs);
+// Waits for every load issued so far and uploads it, for loading screens and world init
+void finish(RenderContext& context);
+
+// Failed also for handles that are done with
+State state(Handle handle);
+// Hands over the texture once the load is no longer Pending, empty if it failed, and frees the
+// load: the handle is done with afterwards. An empty texture while Pending.
+Texture texture(Handle handle);
+// Loads not uploaded yet
+int pendingCount();
 
-};
\ No newline at end of file
+};
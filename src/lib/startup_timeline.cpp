@@ -0,0 +1,257 @@
+#include "startup_timeline.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "misc.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+constexpr int SLOWEST_ASSETS = 3;
+
+struct PhaseRecord {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    int depth;
+};
+
+struct AssetRecord {
+    std::string name;
+    StartupTimeline::Step step;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t end;
+};
+
+std::atomic<bool> s_recording{false};
+bool s_started = false;
+uint64_t s_start = 0;
+uint64_t s_end = 0;
+// Logs the summary and writes the trace after finish(), when nothing adds to the records anymore
+SDL_Thread* s_writer = nullptr;
+
+// Main thread only
+std::vector<PhaseRecord> s_phases;
+std::vector<size_t> s_open;
+
+std::mutex s_assetMutex;
+std::vector<AssetRecord> s_assets;
+
+std::atomic<uint32_t> s_nextThread{0};
+
+// Small numbers for the trace, the main thread is 0 since it calls start()
+uint32_t threadIndex() {
+    thread_local uint32_t index = s_nextThread.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+const char* stepName(StartupTimeline::Step step) {
+    return step == StartupTimeline::Step::Decode ? "decode" : "upload";
+}
+
+void writeEscaped(FILE* file, const char* str) {
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(static_cast<unsigned char>(*str) < 0x20 ? ' ' : *str, file);
+    }
+}
+
+bool writeTrace(const char* path, uint64_t end) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StartupTimeline: could not open %s", path);
+        return false;
+    }
+
+    const double toMicroseconds = 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+    auto timestamp = [&](uint64_t ticks) {
+        return ticks > s_start ? (ticks - s_start) * toMicroseconds : 0.0;
+    };
+
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    std::fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, "
+                       "\"args\": {\"name\": \"main\"}}");
+    std::fprintf(file, ",\n{\"name\": \"First frame\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 0, "
+                       "\"tid\": 0, \"ts\": %.3f}",
+                 timestamp(end));
+    for (const auto& phase : s_phases) {
+        std::fprintf(file, ",\n{\"name\": \"");
+        writeEscaped(file, phase.name);
+        std::fprintf(file, "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0");
+        std::fprintf(file, ", \"ts\": %.3f, \"dur\": %.3f}", timestamp(phase.start),
+                     (phase.end - phase.start) * toMicroseconds);
+    }
+    for (const auto& asset : s_assets) {
+        std::fprintf(file, ",\n{\"name\": \"%s ", stepName(asset.step));
+        writeEscaped(file, asset.name.c_str());
+        std::fprintf(file, "\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u",
+                     stepName(asset.step), asset.thread);
+        std::fprintf(file, ", \"ts\": %.3f, \"dur\": %.3f}", timestamp(asset.start),
+                     (asset.end - asset.start) * toMicroseconds);
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+void logSummary(uint64_t end) {
+    SDL_Log("StartupTimeline: first frame after %.1f ms", Profiler::toMilliseconds(end - s_start));
+    for (const auto& phase : s_phases) {
+        SDL_Log("StartupTimeline: %*s%s %.1f ms", phase.depth * 2, "", phase.name,
+                Profiler::toMilliseconds(phase.end - phase.start));
+    }
+    if (s_assets.empty()) {
+        return;
+    }
+
+    // Summed over threads, next to the wall time from the first to the last step of a kind
+    struct StepTotals {
+        uint64_t ticks = 0;
+        uint64_t first = UINT64_MAX;
+        uint64_t last = 0;
+        uint32_t threads = 0;
+    };
+    StepTotals steps[2];
+    std::map<std::string_view, std::array<uint64_t, 2>> perAsset;
+    for (const auto& asset : s_assets) {
+        const int step = static_cast<int>(asset.step);
+        auto& totals = steps[step];
+        totals.ticks += asset.end - asset.start;
+        totals.first = std::min(totals.first, asset.start);
+        totals.last = std::max(totals.last, asset.end);
+        totals.threads |= asset.thread < 32 ? 1u << asset.thread : 0u;
+        perAsset[asset.name][step] += asset.end - asset.start;
+    }
+    for (int step = 0; step < 2; step++) {
+        const auto& totals = steps[step];
+        if (totals.ticks == 0) {
+            continue;
+        }
+        SDL_Log("StartupTimeline: %s %.1f ms on %d threads, %.1f ms from first to last",
+                stepName(static_cast<StartupTimeline::Step>(step)),
+                Profiler::toMilliseconds(totals.ticks), std::popcount(totals.threads),
+                Profiler::toMilliseconds(totals.last - totals.first));
+    }
+
+    std::vector<std::pair<std::string_view, std::array<uint64_t, 2>>> slowest;
+    for (const auto& [name, ticks] : perAsset) {
+        slowest.emplace_back(name, ticks);
+    }
+    auto total = [](const auto& asset) { return asset.second[0] + asset.second[1]; };
+    const auto count = std::min<size_t>(slowest.size(), SLOWEST_ASSETS);
+    std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+                      [&](const auto& a, const auto& b) { return total(a) > total(b); });
+    SDL_Log("StartupTimeline: %d assets, slowest:", static_cast<int>(perAsset.size()));
+    for (size_t i = 0; i < count; i++) {
+        const auto& [name, ticks] = slowest[i];
+        SDL_Log("StartupTimeline:   %.*s decode %.2f ms, upload %.2f ms",
+                static_cast<int>(name.size()), name.data(), Profiler::toMilliseconds(ticks[0]),
+                Profiler::toMilliseconds(ticks[1]));
+    }
+}
+
+int writeTimeline(void*) {
+    logSummary(s_end);
+    auto path = prefPath("startup.json");
+    if (writeTrace(path.c_str(), s_end)) {
+        SDL_Log("StartupTimeline: wrote %s", path.c_str());
+    }
+    s_phases = {};
+    s_assets = {};
+    return 0;
+}
+
+}  // namespace
+
+void StartupTimeline::start() {
+    if (s_started) {
+        return;
+    }
+    threadIndex();
+    s_started = true;
+    s_start = SDL_GetPerformanceCounter();
+    s_recording.store(true, std::memory_order_release);
+}
+
+void StartupTimeline::finish() {
+    if (!recording()) {
+        return;
+    }
+    s_end = SDL_GetPerformanceCounter();
+    {
+        // Workers may still be decoding something, their later steps are dropped
+        std::lock_guard lock(s_assetMutex);
+        s_recording.store(false, std::memory_order_release);
+    }
+    for (auto index : s_open) {
+        s_phases[index].end = s_end;
+    }
+    s_open.clear();
+
+    // Off the main thread, so the file is not written during a frame
+    s_writer = SDL_CreateThread(writeTimeline, "q14-startup-timeline", nullptr);
+    if (!s_writer) {
+        writeTimeline(nullptr);
+    }
+}
+
+void StartupTimeline::shutdown() {
+    if (s_writer) {
+        SDL_WaitThread(s_writer, nullptr);
+        s_writer = nullptr;
+    }
+}
+
+bool StartupTimeline::recording() {
+    return s_recording.load(std::memory_order_acquire);
+}
+
+void StartupTimeline::begin(const char* name) {
+    if (!recording()) {
+        return;
+    }
+    s_open.push_back(s_phases.size());
+    s_phases.push_back({name, SDL_GetPerformanceCounter(), 0, static_cast<int>(s_open.size()) - 1});
+}
+
+void StartupTimeline::end() {
+    if (s_open.empty()) {
+        return;
+    }
+    s_phases[s_open.back()].end = SDL_GetPerformanceCounter();
+    s_open.pop_back();
+}
+
+void StartupTimeline::asset(std::string_view name,
+                            const void* data,
+                            Step step,
+                            uint64_t start,
+                            uint64_t end) {
+    if (!recording()) {
+        return;
+    }
+    std::string label(name);
+    if (label.empty()) {
+        char address[32];
+        std::snprintf(address, sizeof(address), "asset %p", data);
+        label = address;
+    }
+    const uint32_t thread = threadIndex();
+    std::lock_guard lock(s_assetMutex);
+    if (recording()) {
+        s_assets.push_back({std::move(label), step, thread, start, end});
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Where the time goes between SDL_AppInit and the first presented frame: nested phases such as
+// App::init and GameWorld::init on the main thread, and the decode and upload of every asset on
+// whichever thread did it.
+//
+//   void GameWorld::init(...) {
+//       StartupPhase phase("GameWorld::init");
+//       ...
+//   }
+//
+// App calls finish() after the first frame. A background thread then logs a summary and writes the
+// timeline as a Chrome trace to startup.json in the pref path, a baseline for parallel or lazy
+// loading. Nothing is recorded after that, the calls return right away.
+namespace StartupTimeline {
+
+enum class Step : uint8_t { Decode, Upload };
+
+// Time zero of the timeline, called first thing in SDL_AppInit. Later calls do nothing.
+void start();
+// Stops recording and starts the thread that logs the summary and writes the trace, once
+void finish();
+// Waits for that thread, before exit
+void shutdown();
+// False before start() and after finish()
+bool recording();
+
+// Used by StartupPhase, main thread only. The name must be a string literal.
+void begin(const char* name);
+void end();
+
+// An asset step that ran from start to end (performance counter ticks). Thread safe, the name is
+// copied, an empty name is replaced by the address of the asset's data.
+void asset(std::string_view name, const void* data, Step step, uint64_t start, uint64_t end);
+
+}  // namespace StartupTimeline
+
+class StartupPhase {
+  public:
+    explicit StartupPhase(const char* name) {
+        StartupTimeline::begin(name);
+    }
+    ~StartupPhase() {
+        StartupTimeline::end();
+    }
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+};
@@ -4,6 +4,10 @@
  * Changes:
  * Updated for SDL3
  * Fixed mouse coordinates
+ * Retained rendering: unchanged frames skip nk_convert and draw a cached target texture
+ * The target covers the bounds of the converted vertices, not the whole output
+ * The target blends with premultipliedBlendMode() of gfx.hpp, which has to be included first
+ * Vertices and clip rects are scaled to pixels here, the render scale is left alone
  *
  * Todo:
  * Make global context non-global
@@ -31,6 +35,8 @@ NK_API void nk_sdl_font_stash_begin(struct nk_font_atlas** atlas);
 NK_API void nk_sdl_font_stash_end(void);
 NK_API int nk_sdl_handle_event(SDL_Event* evt);
 NK_API void nk_sdl_render(enum nk_anti_aliasing);
+/* Frames rendered and how many of them reused the last frame's UI */
+NK_API void nk_sdl_render_stats(Uint64* frames, Uint64* cached_frames);
 NK_API void nk_sdl_shutdown(void);
 NK_API void nk_sdl_handle_grab(void);
 
@@ -62,6 +68,30 @@ struct nk_sdl_device {
     struct nk_buffer cmds;
     struct nk_draw_null_texture tex_null;
     SDL_Texture* font_tex;
+    /* the last conversion, kept until the UI changes */
+    struct nk_buffer vbuf;
+    struct nk_buffer ebuf;
+    int empty;
+    /* output pixels covered by the converted vertices */
+    SDL_Rect bounds;
+    /* copy of the command buffer it was converted from */
+    void* last_cmds;
+    nk_size last_size;
+    nk_size last_capacity;
+    enum nk_anti_aliasing last_aa;
+    int last_width;
+    int last_height;
+    float last_scale_x;
+    float last_scale_y;
+    int last_valid;
+    SDL_Texture* target;
+    int target_width;
+    int target_height;
+    int target_failed;
+    /* the last conversion was drawn into target, its vertices are relative to bounds */
+    int target_valid;
+    Uint64 frames;
+    Uint64 cached_frames;
 };
 
 struct nk_sdl_vertex {
@@ -112,28 +142,153 @@ NK_INTERN void nk_sdl_device_upload_atlas(const void* image, int width, int heig
     dev->font_tex = g_SDLFontTexture;
 }
 
-NK_API void nk_sdl_render(enum nk_anti_aliasing AA) {
-    /* setup global state */
+NK_INTERN void nk_sdl_draw(int origin_x, int origin_y) {
+    /* draws the retained draw list to the current target, whose top left corner is at origin on
+     * the output. The vertices are moved there already, the clip rects are moved here. */
     struct nk_sdl_device* dev = &sdl.ogl;
-    float scaleX, scaleY;
-    SDL_GetRenderScale(sdl.renderer, &scaleX, &scaleY);
-    SDL_SetRenderScale(sdl.renderer, sdl.render_scale_x, sdl.render_scale_y);
-    {
-        SDL_Rect saved_clip;
+    SDL_Rect saved_clip;
+#ifdef NK_SDL_CLAMP_CLIP_RECT
+    SDL_Rect viewport;
+#endif
+    SDL_bool clipping_enabled;
+    int vs = sizeof(struct nk_sdl_vertex);
+    size_t vp = offsetof(struct nk_sdl_vertex, position);
+    size_t vt = offsetof(struct nk_sdl_vertex, uv);
+    size_t vc = offsetof(struct nk_sdl_vertex, col);
+    const struct nk_draw_command* cmd;
+    const nk_draw_index* offset = (const nk_draw_index*)nk_buffer_memory_const(&dev->ebuf);
+    const void* vertices = nk_buffer_memory_const(&dev->vbuf);
+
+    clipping_enabled = SDL_RenderClipEnabled(sdl.renderer);
+    SDL_GetRenderClipRect(sdl.renderer, &saved_clip);
+#ifdef NK_SDL_CLAMP_CLIP_RECT
+    SDL_GetRenderViewport(sdl.renderer, &viewport);
+#endif
+
+    nk_draw_foreach(cmd, &sdl.ctx, &dev->cmds) {
+        if (!cmd->elem_count)
+            continue;
+
+        {
+            SDL_Rect r;
+            r.x = (int)(cmd->clip_rect.x * sdl.render_scale_x) - origin_x;
+            r.y = (int)(cmd->clip_rect.y * sdl.render_scale_y) - origin_y;
+            r.w = (int)(cmd->clip_rect.w * sdl.render_scale_x);
+            r.h = (int)(cmd->clip_rect.h * sdl.render_scale_y);
 #ifdef NK_SDL_CLAMP_CLIP_RECT
-        SDL_Rect viewport;
+            if (r.x < 0) {
+                r.w += r.x;
+                r.x = 0;
+            }
+            if (r.y < 0) {
+                r.h += r.y;
+                r.y = 0;
+            }
+            if (r.h > viewport.h) {
+                r.h = viewport.h;
+            }
+            if (r.w > viewport.w) {
+                r.w = viewport.w;
+            }
 #endif
-        SDL_bool clipping_enabled;
-        int vs = sizeof(struct nk_sdl_vertex);
-        size_t vp = offsetof(struct nk_sdl_vertex, position);
-        size_t vt = offsetof(struct nk_sdl_vertex, uv);
-        size_t vc = offsetof(struct nk_sdl_vertex, col);
+            SDL_SetRenderClipRect(sdl.renderer, &r);
+        }
+
+        SDL_RenderGeometryRaw(sdl.renderer, (SDL_Texture*)cmd->texture.ptr,
+                              (const float*)((const nk_byte*)vertices + vp), vs,
+                              (const SDL_Color*)((const nk_byte*)vertices + vc), vs,
+                              (const float*)((const nk_byte*)vertices + vt), vs,
+                              static_cast<int>(dev->vbuf.needed / vs), (void*)offset,
+                              cmd->elem_count, 2);
 
-        /* convert from command queue into draw list and draw to screen */
-        const struct nk_draw_command* cmd;
-        const nk_draw_index* offset = NULL;
-        struct nk_buffer vbuf, ebuf;
+        offset += cmd->elem_count;
+    }
 
+    SDL_SetRenderClipRect(sdl.renderer, &saved_clip);
+    if (!clipping_enabled) {
+        SDL_SetRenderClipRect(sdl.renderer, NULL);
+    }
+}
+
+NK_INTERN int nk_sdl_commands_changed(enum nk_anti_aliasing AA, int width, int height) {
+    /* the command buffer of this frame against a copy of the last converted one, which needs
+     * NK_ZERO_COMMAND_MEMORY so padding compares equal. Images are compared by handle only. */
+    struct nk_sdl_device* dev = &sdl.ogl;
+    const void* cmds = nk_buffer_memory_const(&sdl.ctx.memory);
+    nk_size size = sdl.ctx.memory.allocated;
+
+    if (dev->last_valid && dev->last_size == size && dev->last_aa == AA &&
+        dev->last_width == width && dev->last_height == height &&
+        dev->last_scale_x == sdl.render_scale_x && dev->last_scale_y == sdl.render_scale_y &&
+        memcmp(dev->last_cmds, cmds, size) == 0) {
+        return 0;
+    }
+    if (size > dev->last_capacity) {
+        void* last = realloc(dev->last_cmds, size);
+        if (!last) {
+            dev->last_valid = 0;
+            return 1;
+        }
+        dev->last_cmds = last;
+        dev->last_capacity = size;
+    }
+    if (size) {
+        memcpy(dev->last_cmds, cmds, size);
+    }
+    dev->last_size = size;
+    dev->last_aa = AA;
+    dev->last_width = width;
+    dev->last_height = height;
+    dev->last_scale_x = sdl.render_scale_x;
+    dev->last_scale_y = sdl.render_scale_y;
+    dev->last_valid = 1;
+    return 1;
+}
+
+NK_INTERN SDL_Texture* nk_sdl_target(int width, int height) {
+    /* a transparent texture of at least width x height holding the drawn UI in premultiplied
+     * alpha, NULL when the renderer has no render targets or custom blend modes. It only grows,
+     * so moving or resizing the window does not create a texture every frame. */
+    struct nk_sdl_device* dev = &sdl.ogl;
+    if (dev->target_failed || width <= 0 || height <= 0) {
+        return NULL;
+    }
+    if (dev->target && dev->target_width >= width && dev->target_height >= height) {
+        return dev->target;
+    }
+    width = NK_MAX(width, dev->target_width);
+    height = NK_MAX(height, dev->target_height);
+    SDL_DestroyTexture(dev->target);
+    dev->target = SDL_CreateTexture(sdl.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!dev->target || SDL_SetTextureBlendMode(dev->target, premultipliedBlendMode()) != 0) {
+        SDL_Log("nuklear: no cached render target (%s), drawing the UI every frame",
+                SDL_GetError());
+        SDL_DestroyTexture(dev->target);
+        dev->target = NULL;
+        dev->target_failed = 1;
+        return NULL;
+    }
+    SDL_SetTextureScaleMode(dev->target, SDL_SCALEMODE_NEAREST);
+    dev->target_width = width;
+    dev->target_height = height;
+    return dev->target;
+}
+
+NK_API void nk_sdl_render(enum nk_anti_aliasing AA) {
+    /* The UI is converted and drawn into a cached target texture only when its command buffer
+     * differs from the last frame, otherwise the texture is drawn again with a single quad.
+     * Without a target texture the retained vertices are drawn again, skipping the conversion. */
+    struct nk_sdl_device* dev = &sdl.ogl;
+    int width = 0, height = 0;
+    int changed;
+    SDL_Texture* target;
+
+    SDL_GetCurrentRenderOutputSize(sdl.renderer, &width, &height);
+    changed = nk_sdl_commands_changed(AA, width, height);
+    dev->frames++;
+
+    if (changed) {
         /* fill converting configuration */
         struct nk_convert_config config;
         static const struct nk_draw_vertex_layout_element vertex_layout[] = {
@@ -153,75 +308,72 @@ NK_API void nk_sdl_render(enum nk_anti_aliasing AA) {
         config.shape_AA = AA;
         config.line_AA = AA;
 
-        /* convert shapes into vertexes */
-        nk_buffer_init_default(&vbuf);
-        nk_buffer_init_default(&ebuf);
-        nk_convert(&sdl.ctx, &dev->cmds, &vbuf, &ebuf, &config);
-
-        /* iterate over and execute each draw command */
-        offset = (const nk_draw_index*)nk_buffer_memory_const(&ebuf);
-
-        clipping_enabled = SDL_RenderClipEnabled(sdl.renderer);
-        SDL_GetRenderClipRect(sdl.renderer, &saved_clip);
-#ifdef NK_SDL_CLAMP_CLIP_RECT
-        SDL_GetRenderViewport(sdl.renderer, &viewport);
-#endif
-
-        nk_draw_foreach(cmd, &sdl.ctx, &dev->cmds) {
-            if (!cmd->elem_count)
-                continue;
-
-            {
-                SDL_Rect r;
-                r.x = cmd->clip_rect.x;
-                r.y = cmd->clip_rect.y;
-                r.w = cmd->clip_rect.w;
-                r.h = cmd->clip_rect.h;
-#ifdef NK_SDL_CLAMP_CLIP_RECT
-                if (r.x < 0) {
-                    r.w += r.x;
-                    r.x = 0;
-                }
-                if (r.y < 0) {
-                    r.h += r.y;
-                    r.y = 0;
-                }
-                if (r.h > viewport.h) {
-                    r.h = viewport.h;
-                }
-                if (r.w > viewport.w) {
-                    r.w = viewport.w;
-                }
-#endif
-                SDL_SetRenderClipRect(sdl.renderer, &r);
-            }
-
-            {
-                const void* vertices = nk_buffer_memory_const(&vbuf);
-
-                SDL_RenderGeometryRaw(sdl.renderer, (SDL_Texture*)cmd->texture.ptr,
-                                      (const float*)((const nk_byte*)vertices + vp), vs,
-                                      (const SDL_Color*)((const nk_byte*)vertices + vc), vs,
-                                      (const float*)((const nk_byte*)vertices + vt), vs,
-                                      static_cast<int>(vbuf.needed / vs), (void*)offset,
-                                      cmd->elem_count, 2);
-
-                offset += cmd->elem_count;
+        /* convert shapes into vertexes, reusing the buffers of the last conversion */
+        nk_buffer_clear(&dev->cmds);
+        nk_buffer_clear(&dev->vbuf);
+        nk_buffer_clear(&dev->ebuf);
+        nk_convert(&sdl.ctx, &dev->cmds, &dev->vbuf, &dev->ebuf, &config);
+        dev->empty = dev->ebuf.needed == 0;
+
+        /* to pixels once per conversion, instead of a render scale set and restored every frame,
+         * and the bounds of the result on the output */
+        {
+            struct nk_sdl_vertex* vertex = (struct nk_sdl_vertex*)nk_buffer_memory(&dev->vbuf);
+            struct nk_sdl_vertex* end = vertex + dev->vbuf.needed / sizeof(struct nk_sdl_vertex);
+            float min_x = (float)width, min_y = (float)height, max_x = 0.0f, max_y = 0.0f;
+            for (; vertex < end; vertex++) {
+                vertex->position[0] *= sdl.render_scale_x;
+                vertex->position[1] *= sdl.render_scale_y;
+                min_x = NK_MIN(min_x, vertex->position[0]);
+                min_y = NK_MIN(min_y, vertex->position[1]);
+                max_x = NK_MAX(max_x, vertex->position[0]);
+                max_y = NK_MAX(max_y, vertex->position[1]);
             }
+            dev->bounds.x = (int)SDL_floorf(NK_MAX(min_x, 0.0f));
+            dev->bounds.y = (int)SDL_floorf(NK_MAX(min_y, 0.0f));
+            dev->bounds.w = NK_MAX((int)SDL_ceilf(NK_MIN(max_x, (float)width)) - dev->bounds.x, 0);
+            dev->bounds.h = NK_MAX((int)SDL_ceilf(NK_MIN(max_y, (float)height)) - dev->bounds.y, 0);
         }
 
-        SDL_SetRenderClipRect(sdl.renderer, &saved_clip);
-        if (!clipping_enabled) {
-            SDL_SetRenderClipRect(sdl.renderer, NULL);
+        /* drawn into the target with its top left corner at the bounds' */
+        target = nk_sdl_target(dev->bounds.w, dev->bounds.h);
+        if (target) {
+            struct nk_sdl_vertex* vertex = (struct nk_sdl_vertex*)nk_buffer_memory(&dev->vbuf);
+            struct nk_sdl_vertex* end = vertex + dev->vbuf.needed / sizeof(struct nk_sdl_vertex);
+            SDL_Texture* previous = SDL_GetRenderTarget(sdl.renderer);
+            Uint8 r, g, b, a;
+            for (; vertex < end; vertex++) {
+                vertex->position[0] -= dev->bounds.x;
+                vertex->position[1] -= dev->bounds.y;
+            }
+            SDL_GetRenderDrawColor(sdl.renderer, &r, &g, &b, &a);
+            SDL_SetRenderTarget(sdl.renderer, target);
+            SDL_SetRenderDrawColor(sdl.renderer, 0, 0, 0, 0);
+            SDL_RenderClear(sdl.renderer);
+            nk_sdl_draw(dev->bounds.x, dev->bounds.y);
+            SDL_SetRenderTarget(sdl.renderer, previous);
+            SDL_SetRenderDrawColor(sdl.renderer, r, g, b, a);
         }
+        dev->target_valid = target != NULL;
+    } else {
+        dev->cached_frames++;
+    }
 
-        nk_clear(&sdl.ctx);
-        nk_buffer_clear(&dev->cmds);
-        nk_buffer_free(&vbuf);
-        nk_buffer_free(&ebuf);
+    if (!dev->target_valid) {
+        nk_sdl_draw(0, 0);
+    } else if (dev->bounds.w > 0 && dev->bounds.h > 0) {
+        SDL_FRect src = {0.0f, 0.0f, (float)dev->bounds.w, (float)dev->bounds.h};
+        SDL_FRect dst = {(float)dev->bounds.x, (float)dev->bounds.y, (float)dev->bounds.w,
+                         (float)dev->bounds.h};
+        SDL_RenderTexture(sdl.renderer, dev->target, &src, &dst);
     }
 
-    SDL_SetRenderScale(sdl.renderer, scaleX, scaleY);
+    nk_clear(&sdl.ctx);
+}
+
+NK_API void nk_sdl_render_stats(Uint64* frames, Uint64* cached_frames) {
+    *frames = sdl.ogl.frames;
+    *cached_frames = sdl.ogl.cached_frames;
 }
 
 static void nk_sdl_clipboard_paste(nk_handle usr, struct nk_text_edit* edit) {
@@ -269,6 +421,9 @@ NK_API struct nk_context* nk_sdl_init(SDL_Window* win, SDL_Renderer* renderer, f
     sdl.ctx.clip.paste = nk_sdl_clipboard_paste;
     sdl.ctx.clip.userdata = nk_handle_ptr(0);
     nk_buffer_init_default(&sdl.ogl.cmds);
+    nk_buffer_init_default(&sdl.ogl.vbuf);
+    nk_buffer_init_default(&sdl.ogl.ebuf);
+    sdl.ogl.empty = 1;
     return &sdl.ctx;
 }
 
@@ -306,6 +461,16 @@ NK_API int nk_sdl_handle_event(const SDL_Event* evt) {
     struct nk_context* ctx = &sdl.ctx;
 
     switch (evt->type) {
+        case SDL_EVENT_RENDER_DEVICE_RESET:
+            /* every texture is lost, the target is created again on the next frame */
+            SDL_DestroyTexture(sdl.ogl.target);
+            sdl.ogl.target = NULL;
+            sdl.ogl.last_valid = 0;
+            return 0;
+        case SDL_EVENT_RENDER_TARGETS_RESET:
+            /* the content of the target is lost, the UI is drawn into it again */
+            sdl.ogl.last_valid = 0;
+            return 0;
         case SDL_EVENT_KEY_UP: /* KEYUP & KEYDOWN share same routine */
         case SDL_EVENT_KEY_DOWN: {
             int down = evt->type == SDL_EVENT_KEY_DOWN;
@@ -446,6 +611,10 @@ void nk_sdl_shutdown(void) {
     SDL_DestroyTexture(dev->font_tex);
     /* glDeleteTextures(1, &dev->font_tex); */
     nk_buffer_free(&dev->cmds);
+    nk_buffer_free(&dev->vbuf);
+    nk_buffer_free(&dev->ebuf);
+    free(dev->last_cmds);
+    SDL_DestroyTexture(dev->target);
     memset(&sdl, 0, sizeof(sdl));
 }
 
@@ -2,6 +2,8 @@
 #include <SDL3/SDL_main.h>
 #include <box2d/box2d.h>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <glm/common.hpp>
 
 #include "lib.hpp"
@@ -24,6 +26,7 @@ void SDL_AppLog(void* userdata, int category, SDL_LogPriority priority, const ch
     }
 
     app->debugger()->log(message);
+    FlightRecorder::log(message);
 };
 
 int SDL_Fail() {
@@ -31,30 +34,94 @@ int SDL_Fail() {
     return -1;
 }
 
-int SDL_AppInit(void** appstate, int argc, char* argv[]) {
-    // init the library, here we make a window so we only need the Video capabilities.
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMEPAD)) {
-        return SDL_Fail();
+// Parses the command line, e.g. "--platforms 100 --crates 1000 --seed 7 --record session.q14i"
+void parseArguments(int argc, char* argv[], AppConfig& app, SceneConfig& scene) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--headless") == 0) {
+            app.fixedStep = true;
+            SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+            SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+            continue;
+        }
+        if (std::strcmp(arg, "--assert-zero-alloc") == 0) {
+            app.assertZeroAllocations = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--no-image-cache") == 0) {
+            app.imageCache = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            break;
+        }
+
+        const char* value = argv[i + 1];
+        if (std::strcmp(arg, "--platforms") == 0) {
+            scene.platforms = std::atoi(value);
+        } else if (std::strcmp(arg, "--crates") == 0) {
+            scene.crates = std::atoi(value);
+        } else if (std::strcmp(arg, "--enemies") == 0) {
+            scene.enemies = std::atoi(value);
+        } else if (std::strcmp(arg, "--enemy-interval") == 0) {
+            scene.enemySpawnInterval = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--projectile-rate") == 0) {
+            scene.projectileRate = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            app.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--record") == 0) {
+            app.recordInputPath = value;
+        } else if (std::strcmp(arg, "--replay") == 0) {
+            app.replayInputPath = value;
+        } else if (std::strcmp(arg, "--assets") == 0) {
+            app.assetArchivePath = value;
+        } else if (std::strcmp(arg, "--spike-budget") == 0) {
+            app.spikeBudgetMs = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--metrics") == 0) {
+            app.metricsAddress = value;
+        } else {
+            continue;
+        }
+        i++;
     }
+}
 
-    std::srand(static_cast<unsigned int>(std::time(NULL)));
-
+int SDL_AppInit(void** appstate, int argc, char* argv[]) {
+    StartupTimeline::start();
+    StartupPhase phase("SDL_AppInit");
     // set up the application data
     AppConfig config;
     config.name = version();
     config.width = 1280;
     config.height = 1024;
     config.clearColor = {194, 227, 232, 255};
+    config.seed = static_cast<uint64_t>(std::time(NULL));
+
+    SceneConfig scene;
+    parseArguments(argc, argv, config, scene);
+
+    // init the library, here we make a window so we only need the Video capabilities.
+    {
+        StartupPhase initPhase("SDL_Init");
+        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMEPAD)) {
+            return SDL_Fail();
+        }
+    }
+
+    math::seed(config.seed);
+    ResourceLoader::init();
+
     auto app = new App();
     *appstate = app;
     app->init(config);
 
-    app->setWorld(std::make_unique<GameWorld>());
+    app->setWorld(std::make_unique<GameWorld>(scene));
 
     auto log = new AppLogUserData;
     log->userdata = app;
     SDL_GetLogOutputFunction(&log->original_output_function, &log->original_userdata);
     SDL_SetLogOutputFunction(SDL_AppLog, log);
+    Log::init();
 
     SDL_Log("SDL: %d.%d.%d", SDL_MAJOR_VERSION, SDL_MINOR_VERSION, SDL_MICRO_VERSION);
     SDL_Log("GLM: %d.%d.%d", GLM_VERSION_MAJOR, GLM_VERSION_MINOR, GLM_VERSION_PATCH);
@@ -79,12 +146,9 @@ int SDL_AppIterate(void* appstate) {
 }
 
 void SDL_AppQuit(void* appstate) {
-    auto* app = reinterpret_cast<App*>(appstate);
-    if (app) {
-        SDL_DestroyRenderer(app->renderer());
-        SDL_DestroyWindow(app->window());
-        delete app;
-    }
+    // The log output still goes to the debugger, so write everything pending before it goes away
+    Log::shutdown();
+    ResourceLoader::shutdown();
 
     void* userdata = nullptr;
     SDL_GetLogOutputFunction(nullptr, &userdata);
@@ -94,6 +158,16 @@ void SDL_AppQuit(void* appstate) {
         delete log;
     }
 
+    auto* app = reinterpret_cast<App*>(appstate);
+    if (app) {
+        // The world releases its textures, so it has to go before the renderer
+        auto renderer = app->renderer();
+        auto window = app->window();
+        delete app;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+    }
+
     SDL_Quit();
     SDL_Log("Application quit successfully!");
 }
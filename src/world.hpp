@@ -1,6 +1,7 @@
 #pragma once
 
 #include <box2d/box2d.h>
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -13,13 +14,31 @@ struct GameContext {
     // TODO: TEMP...
     std::vector<GameObject>* gameObjects;
     PhysicsSystem* physics;
+    math::Random* random;
+    // Receives the objects created while gameObjects is being iterated, the owner moves them in
+    // afterwards. Objects go straight into gameObjects when not set
+    std::vector<GameObject>* pendingObjects = nullptr;
 
     GameObject& createObject();
 };
 
+// Describes the level built by GameWorld::init, used to scale entity counts for stress tests
+struct SceneConfig {
+    // Number of generated platforms, 0 keeps the hand-made level
+    int platforms = 0;
+    // Number of crates scattered over a generated level
+    int crates = 0;
+    // Maximum number of AI characters alive at the same time
+    int enemies = 6;
+    // Seconds between AI character spawns, 0 spawns all of them right away
+    float enemySpawnInterval = 2.0f;
+    // Projectiles per second fired by random AI characters
+    float projectileRate = 0.0f;
+};
+
 class GameWorld : public World {
   public:
-    GameWorld();
+    GameWorld(SceneConfig config = SceneConfig());
     virtual ~GameWorld();
 
     void init(UpdateContext& updateContext, RenderContext& renderContext) override;
@@ -34,10 +53,25 @@ class GameWorld : public World {
     GameContext getContext();
 
   private:
+    void spawnEnemy(GameContext& context);
+    void spawnProjectile(GameContext& context);
+
+    SceneConfig m_config;
+    Size m_levelSize{16, 16};
+    int m_enemyCount = 0;
+    float m_nextEnemySpawn = 2.0f;
+    float m_projectileBudget = 0.0f;
+    // The world's own random stream, seeded from math::seed so a session can be replayed
+    math::Random m_random;
+
     std::unique_ptr<PhysicsSystem> m_physics;
     // TODO: replace with Camera-object
     Transform m_cameraTransform;
     std::vector<GameObject> m_gameObjects;
+    // Created during GameWorld::update, see GameContext::pendingObjects
+    std::vector<GameObject> m_pendingObjects;
+    // Keeps the sprites' textures alive
+    std::array<TextureRef, 10> m_textures;
 
     bool m_debugPhysics = false;
 };
\ No newline at end of file
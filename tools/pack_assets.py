@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Packs a directory of assets into a .q14a archive, see src/lib/archive.hpp for the format.
+
+    tools/pack_assets.py assets/ build/assets.q14a --compress
+    tools/pack_assets.py --resources src/resources.hpp build/assets.q14a
+
+Entries are named by their path relative to the directory, e.g. "Images/Tiles/Tile_0001.png".
+With --resources the input is the generated header of embedded images instead, and entries are
+named by their namespaces below Resources, so Resources::Images::Tiles::Tile_0001 becomes
+"Images/Tiles/Tile_0001.png", the name the game looks up.
+Files with identical contents are stored once. With --compress an entry is stored as a zlib stream
+when that saves at least an eighth of its size, which is rarely the case for PNGs.
+"""
+
+import argparse
+import hashlib
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = b"Q14A"
+VERSION = 1
+ALIGNMENT = 16
+HEADER = struct.Struct("<4sIIIQQ")
+ENTRY = struct.Struct("<QQIIII")
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+
+def hash_name(name):
+    """64 bit FNV-1a, as ArchiveFormat::hashName"""
+    value = 14695981039346656037
+    for byte in name.encode("utf-8"):
+        value ^= byte
+        value = (value * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return value
+
+
+def align(offset):
+    return (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def collect(root):
+    files = []
+    for directory, _, names in os.walk(root):
+        for name in names:
+            path = os.path.join(directory, name)
+            with open(path, "rb") as f:
+                files.append((os.path.relpath(path, root).replace(os.sep, "/"), f.read()))
+    return sorted(files)
+
+
+def collect_resources(header):
+    """The images embedded by a resources.hpp, named by their namespaces"""
+    namespace_begin = re.compile(r"^namespace (\w+) \{")
+    namespace_end = re.compile(r"^\}\s*// namespace")
+    array = re.compile(r"^inline constexpr const uint8_t _(\w+)_data\[(\d+)\]\{")
+    byte_value = re.compile(r"0x[0-9a-fA-F]{2}")
+    files = []
+    namespaces = []
+    current = None
+    with open(header) as f:
+        for line in f:
+            if current is not None:
+                end = line.find("}")
+                values = line[:end] if end >= 0 else line
+                current[2].extend(int(byte, 16) for byte in byte_value.findall(values))
+                if end >= 0:
+                    name, size, data = current
+                    if len(data) != size:
+                        sys.exit(f"error: {name} has {len(data)} bytes instead of {size}")
+                    if not data.startswith(b"\x89PNG"):
+                        sys.exit(f"error: {name} is not a PNG")
+                    files.append((name, bytes(data)))
+                    current = None
+            elif match := namespace_begin.match(line):
+                namespaces.append(match.group(1))
+            elif namespace_end.match(line):
+                namespaces.pop()
+            elif match := array.match(line):
+                name = "/".join(namespaces[1:] + [match.group(1)]) + ".png"
+                current = (name, int(match.group(2)), bytearray())
+    return sorted(files)
+
+
+def pack(files, output, compress):
+    entries = []
+    hashes = {}
+    for name, data in files:
+        name_hash = hash_name(name)
+        if name_hash in hashes:
+            sys.exit(f"error: {name} and {hashes[name_hash]} have the same name hash")
+        hashes[name_hash] = name
+        stored, compression = data, COMPRESSION_NONE
+        if compress:
+            deflated = zlib.compress(data, 9)
+            if len(deflated) <= len(data) - len(data) // 8:
+                stored, compression = deflated, COMPRESSION_ZLIB
+        entries.append((name_hash, data, stored, compression))
+    entries.sort(key=lambda entry: entry[0])
+
+    toc_offset = HEADER.size
+    offset = align(toc_offset + ENTRY.size * len(entries))
+    blobs = []
+    offsets = {}
+    toc = []
+    for name_hash, data, stored, compression in entries:
+        key = (hashlib.sha1(stored).digest(), compression)
+        if key not in offsets:
+            offsets[key] = offset
+            blobs.append((offset, stored))
+            offset = align(offset + len(stored))
+        toc.append(ENTRY.pack(name_hash, offsets[key], len(data), len(stored), compression, 0))
+    file_size = blobs[-1][0] + len(blobs[-1][1]) if blobs else align(toc_offset)
+
+    with open(output, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, len(entries), 0, toc_offset, file_size))
+        f.write(b"".join(toc))
+        for blob_offset, stored in blobs:
+            f.write(b"\0" * (blob_offset - f.tell()))
+            f.write(stored)
+        f.write(b"\0" * (file_size - f.tell()))
+
+    raw = sum(len(data) for _, data, _, _ in entries)
+    print(f"{output}: {len(entries)} entries, {len(blobs)} blobs, {raw} -> {file_size} bytes")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="directory of assets, or resources.hpp with --resources")
+    parser.add_argument("output")
+    parser.add_argument("--compress", action="store_true", help="zlib compress entries where it pays off")
+    parser.add_argument("--resources", action="store_true", help="pack the images embedded by the header")
+    args = parser.parse_args()
+    files = collect_resources(args.input) if args.resources else collect(args.input)
+    pack(files, args.output, args.compress)
+
+
+if __name__ == "__main__":
+    main()